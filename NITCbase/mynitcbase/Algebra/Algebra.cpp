@@ -1,7 +1,14 @@
 #include "Algebra.h"
+#include "ExternalSort.h"
+#include "Operators.h"
+#include "../BlockAccess/SpillFile.h"
 #include<cstdio>
 #include<cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <vector>
 
 // will return if a string can be parsed as a floating point number
 bool isNumber(char *str) {
@@ -154,6 +161,105 @@ int Algebra::select(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr
     return SUCCESS;
 }
 
+/*
+The operators below (see Operators.h) let a query that combines select, project,
+sort and join run as a single pipeline: each operator pulls the records it needs
+from the one below it, and only the records of the last one are written, to the
+target relation, by materialize(). No intermediate relation is created.
+*/
+
+/* the operator that returns the records of relation relId satisfying `attr op strVal` */
+static int selectPlan(int relId, char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE],
+                      std::unique_ptr<Operator> *plan) {
+  AttrCatEntry attrCatEntry;
+  if(AttrCacheTable::getAttrCatEntry(relId,attr,&attrCatEntry) != SUCCESS)
+    return E_ATTRNOTEXIST;
+
+  Attribute attrVal;
+  if(attrCatEntry.attrType == NUMBER)
+  {
+    if(!isNumber(strVal))
+      return E_ATTRTYPEMISMATCH;
+    attrVal.nVal = atof(strVal);
+  }
+  else
+    strcpy(attrVal.sVal,strVal);
+
+  *plan = std::make_unique<SelectScan>(relId, attr, attrVal, op);
+  return SUCCESS;
+}
+
+/* puts a projection on the attributes tar_Attrs on top of *plan */
+static int projectPlan(std::unique_ptr<Operator> *plan, int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]) {
+  std::vector<int> offsets(tar_nAttrs);
+  for(int i=0;i<tar_nAttrs;i++)
+  {
+    offsets[i] = (*plan)->getAttrOffset(tar_Attrs[i]);
+    if(offsets[i] < 0)
+      return E_ATTRNOTEXIST;
+  }
+  *plan = std::make_unique<Project>(std::move(*plan), offsets);
+  return SUCCESS;
+}
+
+/* creates targetRel with the attributes of the records returned by plan and
+   inserts all of them into it (targetRel is deleted again if that fails) */
+static int materialize(Operator *plan, char targetRel[ATTR_SIZE]) {
+  int numAttrs = plan->getNumAttrs();
+  char attrNames[numAttrs][ATTR_SIZE];
+  int attrTypes[numAttrs];
+  for(int i=0;i<numAttrs;i++)
+  {
+    strcpy(attrNames[i], plan->getAttrs()[i].name);
+    attrTypes[i] = plan->getAttrs()[i].type;
+  }
+
+  int ret = Schema::createRel(targetRel, numAttrs, attrNames, attrTypes);
+  if(ret != SUCCESS)
+    return ret;
+
+  int targetRelId = OpenRelTable::openRel(targetRel);
+  if(targetRelId<0 || targetRelId>=MAX_OPEN)
+  {
+    Schema::deleteRel(targetRel);
+    return targetRelId;
+  }
+
+  Attribute record[numAttrs];
+  ret = plan->open();
+  while(ret == SUCCESS && (ret = plan->next(record)) == SUCCESS)
+    ret = BlockAccess::insert(targetRelId, record);
+  plan->close();
+
+  Schema::closeRel(targetRel);
+  if(ret != E_NOTFOUND)
+  {
+    Schema::deleteRel(targetRel);
+    return ret;
+  }
+  return SUCCESS;
+}
+
+/* select that keeps only the attributes tar_Attrs of the selected records; they
+   are projected as they are found instead of going through a TEMP relation */
+int Algebra::select(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE],
+                    int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]) {
+  int srcRelId = OpenRelTable::getRelId(srcRel);
+  if (srcRelId<0 || srcRelId>=MAX_OPEN) {
+    return E_RELNOTOPEN;
+  }
+
+  // Project(Select(srcRel))
+  std::unique_ptr<Operator> plan;
+  int ret = selectPlan(srcRelId, attr, op, strVal, &plan);
+  if(ret != SUCCESS)
+    return ret;
+  ret = projectPlan(&plan, tar_nAttrs, tar_Attrs);
+  if(ret != SUCCESS)
+    return ret;
+  return materialize(plan.get(), targetRel);
+}
+
 int Algebra::insert(char relName[ATTR_SIZE], int nAttrs, char record[][ATTR_SIZE]){
     // if relName is equal to "RELATIONCAT" or "ATTRIBUTECAT"
     // return E_NOTPERMITTED;
@@ -224,6 +330,192 @@ int Algebra::insert(char relName[ATTR_SIZE], int nAttrs, char record[][ATTR_SIZE
     return retVal;
 }
 
+/*
+    Bulk version of insert() used by INSERT INTO ... VALUES FROM file.
+    records holds numRecords rows of nAttrs values each, row after row.
+    The catalog entries are looked up once, every row is converted with the
+    column types fetched up front, and the rows are written into record blocks
+    by BlockAccess::bulkInsert(). Indexes are maintained once at the end: they
+    are rebuilt bottom-up by bPlusCreate() if the load at least doubles the
+    relation, otherwise the new entries are inserted in key order.
+    Rows are inserted up to the first row that fails; *numInserted is set to
+    the number of rows inserted.
+*/
+int Algebra::bulkInsert(char relName[ATTR_SIZE], int nAttrs, int numRecords, char records[][ATTR_SIZE], int *numInserted){
+    *numInserted = 0;
+    if(strcmp(relName,RELCAT_RELNAME)==0 || strcmp(relName,ATTRCAT_RELNAME)==0)
+        return E_NOTPERMITTED;
+
+    int relId = OpenRelTable::getRelId(relName);
+    if(relId == E_RELNOTOPEN)
+        return relId;
+
+    RelCatEntry relCatEntry;
+    RelCacheTable::getRelCatEntry(relId,&relCatEntry);
+    if(relCatEntry.numAttrs != nAttrs)
+        return E_NATTRMISMATCH;
+    int existingRecords = relCatEntry.numRecs;
+
+    // fetch the attribute catalog entries once for all the rows
+    AttrCatEntry attrCatEntries[nAttrs];
+    for(int i=0;i<nAttrs;i++)
+        AttrCacheTable::getAttrCatEntry(relId,i,&attrCatEntries[i]);
+
+    // convert the rows up to the first one that does not type check
+    std::vector<Attribute> recordValues((long)numRecords*nAttrs);
+    int numValid = 0;
+    int convertError = SUCCESS;
+    for(; numValid<numRecords && convertError==SUCCESS; numValid++)
+    {
+        char (*row)[ATTR_SIZE] = records + (long)numValid*nAttrs;
+        Attribute *values = &recordValues[(long)numValid*nAttrs];
+        for(int i=0;i<nAttrs;i++)
+        {
+            if(attrCatEntries[i].attrType == NUMBER)
+            {
+                if(!isNumber(row[i]))
+                {
+                    convertError = E_ATTRTYPEMISMATCH;
+                    break;
+                }
+                values[i].nVal = atof(row[i]);
+            }
+            else
+                strcpy(values[i].sVal,row[i]);
+        }
+    }
+    if(convertError != SUCCESS)
+        numValid--;
+
+    std::vector<RecId> recIds(numValid > 0 ? numValid : 1);
+    int inserted = 0;
+    int retVal = BlockAccess::bulkInsert(relId,recordValues.data(),numValid,recIds.data(),&inserted);
+    *numInserted = inserted;
+
+    /* B+ Tree maintenance for the inserted records */
+    // if the load at least doubles the relation the index is built again
+    // bottom-up; otherwise the new entries are inserted in key order so that
+    // consecutive inserts go to the same leaf (stable, so equal keys keep
+    // their insertion order as with row-by-row inserts)
+    int flag = SUCCESS;
+    std::vector<int> order(inserted);
+    for(int i=0;i<nAttrs && inserted>0;i++)
+    {
+        AttrCatEntry attrCatEntry;
+        AttrCacheTable::getAttrCatEntry(relId,i,&attrCatEntry);
+        if(attrCatEntry.rootBlock == -1)
+            continue;
+
+        if(inserted >= existingRecords)
+        {
+            BPlusTree::bPlusDestroy(attrCatEntry.rootBlock);
+            attrCatEntry.rootBlock = -1;
+            AttrCacheTable::setAttrCatEntry(relId,attrCatEntry.attrName,&attrCatEntry);
+            if(BPlusTree::bPlusCreate(relId,attrCatEntry.attrName) != SUCCESS)
+                flag = E_INDEX_BLOCKS_RELEASED;
+            continue;
+        }
+
+        for(int r=0;r<inserted;r++)
+            order[r] = r;
+        int attrType = attrCatEntry.attrType;
+        std::stable_sort(order.begin(), order.end(), [&](int x, int y) {
+            return compareAttrs(recordValues[(long)x*nAttrs + i], recordValues[(long)y*nAttrs + i], attrType) < 0;
+        });
+
+        for(int r=0;r<inserted;r++)
+        {
+            Attribute attrVal = recordValues[(long)order[r]*nAttrs + i];
+            if(BPlusTree::bPlusInsert(relId,attrCatEntry.attrName,attrVal,recIds[order[r]]) == E_DISKFULL)
+            {
+                // (index for this attribute has been destroyed)
+                flag = E_INDEX_BLOCKS_RELEASED;
+                break;
+            }
+        }
+    }
+
+    if(retVal != SUCCESS)
+        return retVal;
+    if(convertError != SUCCESS)
+        return convertError;
+    return flag;
+}
+
+/* deletes every record of relName that satisfies `attr op strVal`, and its
+   entries in the indexes of the relation. *numDeleted is set to the number of
+   records deleted */
+int Algebra::deleteWhere(char relName[ATTR_SIZE], char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE],
+                         int *numDeleted) {
+    *numDeleted = 0;
+    if(strcmp(relName,RELCAT_RELNAME)==0 || strcmp(relName,ATTRCAT_RELNAME)==0)
+        return E_NOTPERMITTED;
+
+    int relId = OpenRelTable::getRelId(relName);
+    if(relId<0 || relId>=MAX_OPEN)
+        return E_RELNOTOPEN;
+
+    AttrCatEntry attrCatEntry;
+    int ret = AttrCacheTable::getAttrCatEntry(relId,attr,&attrCatEntry);
+    if(ret != SUCCESS)
+        return E_ATTRNOTEXIST;
+
+    // convert strVal to an attribute of the type of attr
+    Attribute attrVal;
+    if(attrCatEntry.attrType == NUMBER)
+    {
+        if(!isNumber(strVal))
+            return E_ATTRTYPEMISMATCH;
+        attrVal.nVal = atof(strVal);
+    }
+    else
+        strcpy(attrVal.sVal,strVal);
+
+    return BlockAccess::deleteRecords(relId, attr, attrVal, op, numDeleted);
+}
+
+/* sets setAttr to setStrVal in every record of relName that satisfies
+   `attr op strVal`, rewriting the records in place. *numUpdated is set to the
+   number of records updated */
+int Algebra::updateWhere(char relName[ATTR_SIZE], char setAttr[ATTR_SIZE], char setStrVal[ATTR_SIZE],
+                         char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE], int *numUpdated) {
+    *numUpdated = 0;
+    if(strcmp(relName,RELCAT_RELNAME)==0 || strcmp(relName,ATTRCAT_RELNAME)==0)
+        return E_NOTPERMITTED;
+
+    int relId = OpenRelTable::getRelId(relName);
+    if(relId<0 || relId>=MAX_OPEN)
+        return E_RELNOTOPEN;
+
+    AttrCatEntry setAttrCatEntry, attrCatEntry;
+    if(AttrCacheTable::getAttrCatEntry(relId,setAttr,&setAttrCatEntry) != SUCCESS)
+        return E_ATTRNOTEXIST;
+    if(AttrCacheTable::getAttrCatEntry(relId,attr,&attrCatEntry) != SUCCESS)
+        return E_ATTRNOTEXIST;
+
+    // convert both values to attributes of the types of their attributes
+    Attribute newVal, attrVal;
+    if(setAttrCatEntry.attrType == NUMBER)
+    {
+        if(!isNumber(setStrVal))
+            return E_ATTRTYPEMISMATCH;
+        newVal.nVal = atof(setStrVal);
+    }
+    else
+        strcpy(newVal.sVal,setStrVal);
+
+    if(attrCatEntry.attrType == NUMBER)
+    {
+        if(!isNumber(strVal))
+            return E_ATTRTYPEMISMATCH;
+        attrVal.nVal = atof(strVal);
+    }
+    else
+        strcpy(attrVal.sVal,strVal);
+
+    return BlockAccess::updateRecords(relId, setAttr, newVal, attr, attrVal, op, numUpdated);
+}
+
 int Algebra::project(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE]) {
 
     int srcRelId = OpenRelTable::getRelId(srcRel);/*srcRel's rel-id (use OpenRelTable::getRelId() function)*/
@@ -418,7 +710,137 @@ int Algebra::project(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], int tar_
     return SUCCESS;
 }
 
+int Algebra::sortMemoryBlocks = SORT_MEMORY_BLOCKS;
+
+/* sets the number of blocks of memory an external sort (ORDER BY, sort-merge join)
+   may fill with records before it writes them out as a run */
+void Algebra::setSortMemory(int memoryBlocks) {
+  sortMemoryBlocks = memoryBlocks;
+}
+
+/* ORDER BY for SELECT *: sorts srcRel on attr into targetRel keeping every attribute */
+int Algebra::sort(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], bool descending) {
+    int srcRelId = OpenRelTable::getRelId(srcRel);
+    if(srcRelId<0 || srcRelId>=MAX_OPEN)
+      return srcRelId;
+
+    RelCatEntry relCatEntry;
+    RelCacheTable::getRelCatEntry(srcRelId, &relCatEntry);
+    int numAttrs = relCatEntry.numAttrs;
+    char attrNames[numAttrs][ATTR_SIZE];
+    for(int i=0;i<numAttrs;i++)
+    {
+      AttrCatEntry attrCatEntry;
+      AttrCacheTable::getAttrCatEntry(srcRelId, i, &attrCatEntry);
+      strcpy(attrNames[i], attrCatEntry.attrName);
+    }
+
+    return sort(srcRel, targetRel, attr, descending, numAttrs, attrNames);
+}
+
+/*
+Creates targetRel with the attributes tar_Attrs of srcRel and fills it with the
+records of srcRel in ascending (or descending) order of attr, which need not be
+one of tar_Attrs. The records go through an external sort, so srcRel can be
+larger than the memory given by setSortMemory(). Records with equal values of
+attr keep the order they have in srcRel.
+*/
+int Algebra::sort(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], bool descending,
+                  int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]) {
+    int srcRelId = OpenRelTable::getRelId(srcRel);
+    if(srcRelId<0 || srcRelId>=MAX_OPEN)
+      return srcRelId;
+
+    // Project(Sort(scan of srcRel))
+    std::unique_ptr<Operator> plan = std::make_unique<RelationScan>(srcRelId);
+    int sortOffset = plan->getAttrOffset(attr);
+    if(sortOffset<0)
+      return E_ATTRNOTEXIST;
+    plan = std::make_unique<Sort>(std::move(plan), sortOffset, descending, sortMemoryBlocks);
+
+    int ret = projectPlan(&plan, tar_nAttrs, tar_Attrs);
+    if(ret != SUCCESS)
+      return ret;
+    return materialize(plan.get(), targetRel);
+}
+
+/* ORDER BY with a WHERE condition: the records of srcRel that satisfy
+   `selectAttr op strVal`, sorted as by the sort() above (tar_nAttrs is 0 to
+   keep every attribute). The selected records go straight into the sort,
+   without an intermediate relation. */
+int Algebra::sort(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], bool descending,
+                  int tar_nAttrs, char tar_Attrs[][ATTR_SIZE], char selectAttr[ATTR_SIZE], int op,
+                  char strVal[ATTR_SIZE]) {
+    int srcRelId = OpenRelTable::getRelId(srcRel);
+    if(srcRelId<0 || srcRelId>=MAX_OPEN)
+      return E_RELNOTOPEN;
+
+    // Project(Sort(Select(srcRel)))
+    std::unique_ptr<Operator> plan;
+    int ret = selectPlan(srcRelId, selectAttr, op, strVal, &plan);
+    if(ret != SUCCESS)
+      return ret;
+    int sortOffset = plan->getAttrOffset(attr);
+    if(sortOffset<0)
+      return E_ATTRNOTEXIST;
+    plan = std::make_unique<Sort>(std::move(plan), sortOffset, descending, sortMemoryBlocks);
+
+    if(tar_nAttrs > 0)
+    {
+      ret = projectPlan(&plan, tar_nAttrs, tar_Attrs);
+      if(ret != SUCCESS)
+        return ret;
+    }
+    return materialize(plan.get(), targetRel);
+}
+
+enum JoinMethod {
+  INDEX_JOIN,
+  HASH_JOIN,
+  MERGE_JOIN
+};
+
+/* the records of a relation in the order of attr (an input of a sort-merge join
+   or of a sorted GROUP BY): along the index on attr if there is one, otherwise
+   through an external sort */
+static std::unique_ptr<Operator> sortedScan(int relId, AttrCatEntry *attrCatEntry, int memoryBlocks) {
+  if(attrCatEntry->rootBlock!=-1)
+    return std::make_unique<IndexOrderScan>(relId, attrCatEntry);
+  return std::make_unique<Sort>(std::make_unique<RelationScan>(relId), attrCatEntry->offset, false, memoryBlocks);
+}
+
 int Algebra::join(char srcRelation1[ATTR_SIZE],char srcRelation2[ATTR_SIZE],char targetRelation[ATTR_SIZE],char attribute1[ATTR_SIZE],char attribute2[ATTR_SIZE])
+{
+  std::unique_ptr<Operator> plan;
+  int ret=joinPlan(srcRelation1,srcRelation2,attribute1,attribute2,&plan);
+  if(ret!=SUCCESS)
+  {
+    return ret;
+  }
+  return materialize(plan.get(),targetRelation);
+}
+
+/* join of the two relations that keeps only the attributes tar_Attrs of the
+   result; the joined records are projected as they are produced */
+int Algebra::join(char srcRelation1[ATTR_SIZE],char srcRelation2[ATTR_SIZE],char targetRelation[ATTR_SIZE],char attribute1[ATTR_SIZE],char attribute2[ATTR_SIZE],
+                  int tar_nAttrs,char tar_Attrs[][ATTR_SIZE])
+{
+  std::unique_ptr<Operator> plan;
+  int ret=joinPlan(srcRelation1,srcRelation2,attribute1,attribute2,&plan);
+  if(ret!=SUCCESS)
+  {
+    return ret;
+  }
+  ret=projectPlan(&plan,tar_nAttrs,tar_Attrs);
+  if(ret!=SUCCESS)
+  {
+    return ret;
+  }
+  return materialize(plan.get(),targetRelation);
+}
+
+int Algebra::joinPlan(char srcRelation1[ATTR_SIZE],char srcRelation2[ATTR_SIZE],char attribute1[ATTR_SIZE],char attribute2[ATTR_SIZE],
+                      std::unique_ptr<Operator> *plan)
 {
   int srcRelId1=OpenRelTable::getRelId(srcRelation1);
   if(srcRelId1==E_RELNOTOPEN)
@@ -456,7 +878,7 @@ for(int i=0;i<relCatEntry1.numAttrs;i++)
   for(int j=0;j<relCatEntry2.numAttrs;j++)
   {
     AttrCatEntry attrCatEntry2;
-  AttrCacheTable::getAttrCatEntry(srcRelId2,i,&attrCatEntry2);
+  AttrCacheTable::getAttrCatEntry(srcRelId2,j,&attrCatEntry2);
    if(strcmp(attrCatEntry1.attrName,attribute1)!=0||strcmp(attrCatEntry2.attrName,attribute2)!=0)
    {
     if(strcmp(attrCatEntry1.attrName,attrCatEntry2.attrName)==0)
@@ -467,84 +889,382 @@ for(int i=0;i<relCatEntry1.numAttrs;i++)
   }
 
 }
-if(attrCatEntry2.rootBlock==-1)
+/*
+  - both relations indexed on the join attributes: merge the two leaf chains
+  - attribute2 indexed: a root-to-leaf descent per record of the first relation
+    is only worth it when there are fewer of those than blocks of the second
+  - too large for the partitions of a hash join to fit in memory: sort and merge
+  - otherwise both relations are read once by a hash join, building the hash
+    table on the relation with fewer records
+  (NITCBASE_JOIN=index, hash or merge forces one of them, e.g. to compare them)
+*/
+int method=HASH_JOIN;
+long long smallerBytes=(long long)std::min(relCatEntry1.numRecs*relCatEntry1.numAttrs,
+                                           relCatEntry2.numRecs*relCatEntry2.numAttrs)*ATTR_SIZE;
+if(attrCatEntry1.rootBlock!=-1 && attrCatEntry2.rootBlock!=-1)
+  method=MERGE_JOIN;
+else if(attrCatEntry2.rootBlock!=-1 && relCatEntry1.numRecs<relCatEntry2.numBlks)
+  method=INDEX_JOIN;
+else if(smallerBytes>(long long)JOIN_MEMORY_BLOCKS*BLOCK_SIZE*MAX_JOIN_PARTITIONS)
+  method=MERGE_JOIN;
+
+const char *forced=getenv("NITCBASE_JOIN");
+if(forced!=nullptr && strcmp(forced,"index")==0)
+  method=INDEX_JOIN;
+else if(forced!=nullptr && strcmp(forced,"hash")==0)
+  method=HASH_JOIN;
+else if(forced!=nullptr && strcmp(forced,"merge")==0)
+  method=MERGE_JOIN;
+
+if(method==INDEX_JOIN)
 {
-  ret=BPlusTree::bPlusCreate(srcRelId2,attribute2);
-  if(ret!=SUCCESS)
-  {
-    return ret;
-  }
+  *plan=std::make_unique<IndexJoin>(std::make_unique<RelationScan>(srcRelId1),attrCatEntry1.offset,
+                                    srcRelId2,&attrCatEntry2);
 }
-int tar_No_Attrs=relCatEntry1.numAttrs+relCatEntry2.numAttrs-1;
-char tar_Attrs[tar_No_Attrs][ATTR_SIZE];
-int tar_AttrType[tar_No_Attrs];
-int j=0;
-for(int i=0;i<relCatEntry1.numAttrs;i++)
+else if(method==MERGE_JOIN)
 {
-  AttrCatEntry attrCatEntry;
-  AttrCacheTable::getAttrCatEntry(srcRelId1,i,&attrCatEntry);
-  strcpy(tar_Attrs[j],attrCatEntry.attrName);
-  tar_AttrType[j]=attrCatEntry.attrType;
-  j++;
+  // the memory for sorting is shared by the two inputs
+  int memoryBlocks=std::max(1,sortMemoryBlocks/2);
+  *plan=std::make_unique<MergeJoin>(sortedScan(srcRelId1,&attrCatEntry1,memoryBlocks),
+                                    sortedScan(srcRelId2,&attrCatEntry2,memoryBlocks),
+                                    attrCatEntry1.offset,attrCatEntry2.offset);
 }
-
-for(int i=0;i<relCatEntry2.numAttrs;i++)
+else
 {
-  AttrCatEntry attrCatEntry;
-  AttrCacheTable::getAttrCatEntry(srcRelId2,i,&attrCatEntry);
-  if(strcmp(attrCatEntry.attrName,attribute2)!=0)
-  {
-    strcpy(tar_Attrs[j],attrCatEntry.attrName);
-    tar_AttrType[j]=attrCatEntry.attrType;
-    j++;
-  }
+  *plan=std::make_unique<HashJoin>(std::make_unique<RelationScan>(srcRelId1),std::make_unique<RelationScan>(srcRelId2),
+                                   attrCatEntry1.offset,attrCatEntry2.offset,
+                                   relCatEntry1.numRecs<=relCatEntry2.numRecs);
 }
- ret=Schema::createRel(targetRelation,tar_No_Attrs,tar_Attrs,tar_AttrType);
- if(ret!=SUCCESS)
- {
-   return ret;
+return SUCCESS;
 }
-int tarRelId=OpenRelTable::openRel(targetRelation);
-if(tarRelId==E_CACHEFULL)
-{
-  Schema::deleteRel(targetRelation);
-  return E_CACHEFULL;
+
+/*
+The items of a GROUP BY and the running values they keep for one group. The
+state of a group is an array of width() attributes: the value of the grouping
+attribute, the number of records, and one value per item (the sum for SUM and
+AVG, the smallest or largest value so far for MIN and MAX).
+*/
+class GroupAggregates {
+ private:
+  int groupOffset;
+  int groupType;
+  std::vector<int> functions;
+  std::vector<int> offsets;
+  std::vector<int> types;
+
+ public:
+  GroupAggregates(int groupOffset, int groupType, const std::vector<int> &functions,
+                  const std::vector<int> &offsets, const std::vector<int> &types)
+      : groupOffset(groupOffset), groupType(groupType), functions(functions), offsets(offsets), types(types) {}
+
+  int width() {
+    return functions.size() + 2;
+  }
+
+  int getGroupOffset() {
+    return groupOffset;
+  }
+
+  int getGroupType() {
+    return groupType;
+  }
+
+  void add(Attribute *state, Attribute *record) {
+    state[1].nVal += 1;
+    for(int i=0;i<(int)functions.size();i++)
+    {
+      Attribute value = record[offsets[i]];
+      if(functions[i] == AGG_SUM || functions[i] == AGG_AVG)
+        state[2 + i].nVal += value.nVal;
+      else if(functions[i] == AGG_MIN && compareAttrs(value, state[2 + i], types[i]) < 0)
+        state[2 + i] = value;
+      else if(functions[i] == AGG_MAX && compareAttrs(value, state[2 + i], types[i]) > 0)
+        state[2 + i] = value;
+    }
+  }
+
+  // starts the state of a new group with its first record
+  void start(Attribute *state, Attribute *record) {
+    state[0] = record[groupOffset];
+    state[1].nVal = 0;
+    for(int i=0;i<(int)functions.size();i++)
+    {
+      if(functions[i] == AGG_MIN || functions[i] == AGG_MAX)
+        state[2 + i] = record[offsets[i]];
+      else
+        state[2 + i].nVal = 0;
+    }
+    add(state, record);
+  }
+
+  // the record of the target relation for a group
+  void result(Attribute *state, Attribute *record) {
+    for(int i=0;i<(int)functions.size();i++)
+    {
+      if(functions[i] == AGG_NONE)
+        record[i] = state[0];
+      else if(functions[i] == AGG_COUNT)
+        record[i].nVal = state[1].nVal;
+      else if(functions[i] == AGG_AVG)
+        record[i].nVal = state[2 + i].nVal / state[1].nVal;
+      else
+        record[i] = state[2 + i];
+    }
+  }
+};
+
+/* in-memory hash table from the value of the grouping attribute to the state of its group */
+class GroupTable {
+ private:
+  int width;
+  int groupType;
+  std::vector<Attribute> states;
+  std::vector<uint64_t> hashes;
+  std::vector<int> next;
+  std::vector<int> buckets;
+
+  void rebuild(int numBuckets) {
+    buckets.assign(numBuckets, -1);
+    for(int i=0;i<(int)hashes.size();i++)
+    {
+      int bucket = hashes[i] & (numBuckets - 1);
+      next[i] = buckets[bucket];
+      buckets[bucket] = i;
+    }
+  }
+
+ public:
+  GroupTable(int width, int groupType) : width(width), groupType(groupType) {
+    buckets.assign(16, -1);
+  }
+
+  int size() {
+    return hashes.size();
+  }
+
+  Attribute *state(int group) {
+    return &states[(size_t)group * width];
+  }
+
+  // the group with the value key, -1 if there is none yet
+  int find(Attribute key, uint64_t hash) {
+    for(int i = buckets[hash & (buckets.size() - 1)]; i != -1; i = next[i])
+    {
+      if(hashes[i] == hash && compareAttrs(states[(size_t)i * width], key, groupType) == 0)
+        return i;
+    }
+    return -1;
+  }
+
+  // adds a group (its state is left to the caller) and returns its number
+  int insert(uint64_t hash) {
+    int group = hashes.size();
+    states.resize(states.size() + width);
+    hashes.push_back(hash);
+    next.push_back(-1);
+    if(2 * hashes.size() > buckets.size())
+      rebuild(2 * buckets.size());
+    else
+    {
+      int bucket = hash & (buckets.size() - 1);
+      next[group] = buckets[bucket];
+      buckets[bucket] = group;
+    }
+    return group;
+  }
+};
+
+/*
+Hash aggregate of the records returned by input into the target relation.
+Groups are added to an in-memory table until it holds AGGREGATE_MEMORY_BLOCKS
+blocks of state; after that the records of groups that are not in the table are
+written to partitions by the hash of their group value and aggregated in turn
+once the groups in the table are written out. Every group is therefore finished
+in one place, and a partition uses other bits of the hash than the one it was
+split from.
+*/
+static int hashAggregate(Operator &input, int depth, GroupAggregates &aggregates, int targetRelId, int numItems) {
+  int width = aggregates.width();
+  int groupOffset = aggregates.getGroupOffset();
+  int groupType = aggregates.getGroupType();
+  int numAttrs = input.getNumAttrs();
+  int maxGroups = std::max(1, AGGREGATE_MEMORY_BLOCKS * BLOCK_SIZE / (width * ATTR_SIZE));
+
+  GroupTable table(width, groupType);
+  std::vector<SpillFile> partitions;
+  Attribute record[numAttrs];
+
+  int ret = input.open();
+  while(ret == SUCCESS && (ret = input.next(record)) == SUCCESS)
+  {
+    Attribute key = record[groupOffset];
+    uint64_t hash = hashAttr(key, groupType);
+    int group = table.find(key, hash);
+    if(group != -1)
+      aggregates.add(table.state(group), record);
+    else if(table.size() < maxGroups || depth >= MAX_AGGREGATE_DEPTH)
+    {
+      group = table.insert(hash);
+      aggregates.start(table.state(group), record);
+    }
+    else
+    {
+      if(partitions.empty())
+        partitions.assign(AGGREGATE_PARTITIONS, SpillFile(numAttrs));
+      ret = partitions[(hash >> (32 + 8 * depth)) % AGGREGATE_PARTITIONS].append(record);
+    }
+  }
+  input.close();
+  if(ret == E_NOTFOUND)
+    ret = SUCCESS;
+
+  Attribute result[numItems];
+  for(int group = 0; ret == SUCCESS && group < table.size(); group++)
+  {
+    aggregates.result(table.state(group), result);
+    ret = BlockAccess::insert(targetRelId, result);
+  }
+
+  for(int p = 0; p < (int)partitions.size(); p++)
+  {
+    if(ret == SUCCESS && partitions[p].getNumRecords() > 0)
+    {
+      SpillScan partition(&partitions[p], input.getAttrs());
+      ret = hashAggregate(partition, depth + 1, aggregates, targetRelId, numItems);
+    }
+    partitions[p].release();
+  }
+  return ret;
 }
-Attribute record[tar_No_Attrs];
-Attribute record1[relCatEntry1.numAttrs];
-Attribute record2[relCatEntry2.numAttrs];
-RelCacheTable::resetSearchIndex(srcRelId1);
-while(BlockAccess::project(srcRelId1,record1)==SUCCESS)
-{
-  RelCacheTable::resetSearchIndex(srcRelId2);
-  AttrCacheTable::resetSearchIndex(srcRelId2,attribute2);
-  Attribute attrVal=record1[attrCatEntry1.offset];
-  while(BlockAccess::search(srcRelId2,record2,attribute2,attrVal,EQ)==SUCCESS)
+
+/* aggregate of records that arrive in the order of the grouping attribute: a
+   group is finished as soon as a record with another value turns up */
+static int sortedAggregate(Operator &input, GroupAggregates &aggregates, int targetRelId, int numItems) {
+  int ret = input.open();
+  Attribute record[input.getNumAttrs()];
+  Attribute state[aggregates.width()];
+  Attribute result[numItems];
+  bool inGroup = false;
+
+  while(ret == SUCCESS && (ret = input.next(record)) == SUCCESS)
   {
-    int j=0;
-    for(int i=0;i<relCatEntry1.numAttrs;i++)
+    if(inGroup && compareAttrs(record[aggregates.getGroupOffset()], state[0], aggregates.getGroupType()) == 0)
+    {
+      aggregates.add(state, record);
+      continue;
+    }
+    if(inGroup)
     {
-      record[j]=record1[i];
-      j++;
+      aggregates.result(state, result);
+      ret = BlockAccess::insert(targetRelId, result);
     }
-    for(int i=0;i<relCatEntry2.numAttrs;i++)
+    aggregates.start(state, record);
+    inGroup = true;
+  }
+  if(ret == E_NOTFOUND)
+    ret = SUCCESS;
+  if(ret == SUCCESS && inGroup)
+  {
+    aggregates.result(state, result);
+    ret = BlockAccess::insert(targetRelId, result);
+  }
+
+  input.close();
+  return ret;
+}
+
+/*
+SELECT item, ... FROM srcRel INTO targetRel GROUP BY groupAttr. Item i is
+functions[i] applied to the attribute args[i] ("*" for COUNT(*)); an item
+without a function (AGG_NONE) must be groupAttr itself. The target gets one
+record per distinct value of groupAttr. Its attributes are named after the
+items (e.g. sum_marks) and are numbers, except for the grouping attribute and
+MIN / MAX of a string attribute.
+
+When srcRel is indexed on groupAttr the records are read in order along the
+index and aggregated one group at a time; otherwise they are hash aggregated.
+(NITCBASE_AGGREGATE=hash or sort forces one of them, a sort without an index
+going through an external sort.)
+*/
+int Algebra::groupBy(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char groupAttr[ATTR_SIZE], int numItems,
+                     int functions[], char args[][ATTR_SIZE]) {
+    int srcRelId = OpenRelTable::getRelId(srcRel);
+    if(srcRelId<0 || srcRelId>=MAX_OPEN)
+      return srcRelId;
+
+    AttrCatEntry groupAttrCatEntry;
+    if(AttrCacheTable::getAttrCatEntry(srcRelId, groupAttr, &groupAttrCatEntry) != SUCCESS)
+      return E_ATTRNOTEXIST;
+
+    // the attribute every item reads, and the name and type of its attribute in the target
+    std::vector<int> itemFunctions(functions, functions + numItems), offsets(numItems), types(numItems);
+    char tar_Attrs[numItems][ATTR_SIZE];
+    int tar_Types[numItems];
+    for(int i=0;i<numItems;i++)
     {
-      if(i!=attrCatEntry2.offset)
+      AttrCatEntry attrCatEntry = groupAttrCatEntry;
+      if(!(functions[i] == AGG_COUNT && strcmp(args[i], "*") == 0)
+         && AttrCacheTable::getAttrCatEntry(srcRelId, args[i], &attrCatEntry) != SUCCESS)
+        return E_ATTRNOTEXIST;
+      offsets[i] = attrCatEntry.offset;
+      types[i] = attrCatEntry.attrType;
+
+      static const char *prefixes[] = {"", "count", "sum", "min", "max", "avg"};
+      if(functions[i] == AGG_NONE)
       {
-        record[j]=record2[i];
-        j++;
+        // only the grouping attribute has a single value in a group
+        if(attrCatEntry.offset != groupAttrCatEntry.offset)
+          return E_NOTPERMITTED;
+        strcpy(tar_Attrs[i], attrCatEntry.attrName);
+        tar_Types[i] = attrCatEntry.attrType;
       }
+      else
+      {
+        if((functions[i] == AGG_SUM || functions[i] == AGG_AVG) && attrCatEntry.attrType != NUMBER)
+          return E_ATTRTYPEMISMATCH;
+        if(strcmp(args[i], "*") == 0)
+          snprintf(tar_Attrs[i], ATTR_SIZE, "%s", prefixes[functions[i]]);
+        else
+          snprintf(tar_Attrs[i], ATTR_SIZE, "%s_%s", prefixes[functions[i]], attrCatEntry.attrName);
+        tar_Types[i] = (functions[i] == AGG_MIN || functions[i] == AGG_MAX) ? attrCatEntry.attrType : NUMBER;
+      }
+    }
+
+    int ret = Schema::createRel(targetRel, numItems, tar_Attrs, tar_Types);
+    if(ret != SUCCESS)
+      return ret;
+
+    int targetRelId = OpenRelTable::openRel(targetRel);
+    if(targetRelId<0 || targetRelId>=MAX_OPEN)
+    {
+      Schema::deleteRel(targetRel);
+      return targetRelId;
     }
 
-    int ret=BlockAccess::insert(tarRelId,record);
-    if(ret!=SUCCESS)
+    GroupAggregates aggregates(groupAttrCatEntry.offset, groupAttrCatEntry.attrType, itemFunctions, offsets, types);
+    bool sorted = groupAttrCatEntry.rootBlock != -1;
+    const char *forced = getenv("NITCBASE_AGGREGATE");
+    if(forced != nullptr && strcmp(forced, "hash") == 0)
+      sorted = false;
+    else if(forced != nullptr && strcmp(forced, "sort") == 0)
+      sorted = true;
+
+    if(sorted)
     {
-      OpenRelTable::closeRel(tarRelId);
-      Schema::deleteRel(targetRelation);
+      std::unique_ptr<Operator> input = sortedScan(srcRelId, &groupAttrCatEntry, sortMemoryBlocks);
+      ret = sortedAggregate(*input, aggregates, targetRelId, numItems);
+    }
+    else
+    {
+      RelationScan input(srcRelId);
+      ret = hashAggregate(input, 0, aggregates, targetRelId, numItems);
+    }
+
+    Schema::closeRel(targetRel);
+    if(ret != SUCCESS)
+    {
+      Schema::deleteRel(targetRel);
       return ret;
     }
-  }
-}
-OpenRelTable::closeRel(tarRelId);
-return SUCCESS;
+    return SUCCESS;
 }
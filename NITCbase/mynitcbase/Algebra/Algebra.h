@@ -5,23 +5,66 @@
 #include "../Schema/Schema.h"
 #include "../define/constants.h"
 
+#include <memory>
+
+class Operator;
+
 class Algebra {
  public:
   // Insert
   static int insert(char relName[ATTR_SIZE], int numberOfAttributes, char record[][ATTR_SIZE]);
+  static int bulkInsert(char relName[ATTR_SIZE], int numberOfAttributes, int numRecords,
+                        char records[][ATTR_SIZE], int *numInserted);
+
+  // Delete
+  static int deleteWhere(char relName[ATTR_SIZE], char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE],
+                         int *numDeleted);
+
+  // Update
+  static int updateWhere(char relName[ATTR_SIZE], char setAttr[ATTR_SIZE], char setStrVal[ATTR_SIZE],
+                         char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE], int *numUpdated);
 
   // Select
   static int select(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE]);
 
+  // Select + Project
+  static int select(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], int op, char strVal[ATTR_SIZE],
+                    int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]);
+
   // Project all (Copy)
   static int project(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE]);
 
   // Project
   static int project(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]);
 
+  // Sort (ORDER BY)
+  static int sort(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], bool descending);
+  static int sort(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], bool descending,
+                  int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]);
+  static int sort(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char attr[ATTR_SIZE], bool descending,
+                  int tar_nAttrs, char tar_Attrs[][ATTR_SIZE], char selectAttr[ATTR_SIZE], int op,
+                  char strVal[ATTR_SIZE]);
+  static void setSortMemory(int memoryBlocks);
+
+  // Group by (aggregation)
+  static int groupBy(char srcRel[ATTR_SIZE], char targetRel[ATTR_SIZE], char groupAttr[ATTR_SIZE], int numItems,
+                     int functions[], char args[][ATTR_SIZE]);
+
   // Join
   static int join(char srcRelOne[ATTR_SIZE], char srcRelTwo[ATTR_SIZE], char targetRel[ATTR_SIZE],
                   char attrOne[ATTR_SIZE], char attrTwo[ATTR_SIZE]);
+
+  // Join + Project
+  static int join(char srcRelOne[ATTR_SIZE], char srcRelTwo[ATTR_SIZE], char targetRel[ATTR_SIZE],
+                  char attrOne[ATTR_SIZE], char attrTwo[ATTR_SIZE], int tar_nAttrs, char tar_Attrs[][ATTR_SIZE]);
+
+ private:
+  // blocks of memory an external sort may use (see setSortMemory())
+  static int sortMemoryBlocks;
+
+  // the operator that joins srcRelOne and srcRelTwo (see join())
+  static int joinPlan(char srcRelOne[ATTR_SIZE], char srcRelTwo[ATTR_SIZE], char attrOne[ATTR_SIZE],
+                      char attrTwo[ATTR_SIZE], std::unique_ptr<Operator> *plan);
 };
 
 #endif  // NITCBASE_ALGEBRA_H
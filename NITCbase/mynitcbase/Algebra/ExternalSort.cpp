@@ -0,0 +1,183 @@
+#include "ExternalSort.h"
+#include <algorithm>
+#include <cstring>
+
+ExternalSort::ExternalSort(int numAttrs, int keyOffset, int attrType, bool descending, int memoryBlocks) {
+  this->numAttrs = numAttrs;
+  this->keyOffset = keyOffset;
+  this->attrType = attrType;
+  this->descending = descending;
+  this->maxRecords = std::max(1, memoryBlocks * BLOCK_SIZE / (numAttrs * ATTR_SIZE));
+  this->nextRecord = 0;
+  this->inMemory = false;
+  this->mergeFirst = 0;
+  this->mergeCount = 0;
+}
+
+int ExternalSort::compareRecords(Attribute *record1, Attribute *record2) {
+  int cmp = compareAttrs(record1[keyOffset], record2[keyOffset], attrType);
+  return descending ? -cmp : cmp;
+}
+
+/* whether the current record of run1 comes before that of run2 in the merge
+   (a used up run loses to every other; ties go to the earlier run) */
+bool ExternalSort::beats(int run1, int run2) {
+  if (exhausted[run1] || exhausted[run2])
+    return !exhausted[run1] && (exhausted[run2] || run1 < run2);
+  int cmp = compareRecords(&heads[(size_t)run1 * numAttrs], &heads[(size_t)run2 * numAttrs]);
+  return cmp < 0 || (cmp == 0 && run1 < run2);
+}
+
+/* sorts the records in memory (stable, so equal keys keep their order) */
+static void sortOrder(std::vector<int> &order, int numRecords, const std::vector<Attribute> &records,
+                      int numAttrs, int keyOffset, int attrType, bool descending) {
+  order.resize(numRecords);
+  for (int i = 0; i < numRecords; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    int cmp = compareAttrs(records[(size_t)a * numAttrs + keyOffset], records[(size_t)b * numAttrs + keyOffset],
+                           attrType);
+    return descending ? cmp > 0 : cmp < 0;
+  });
+}
+
+int ExternalSort::writeRun() {
+  int numRecords = records.size() / numAttrs;
+  sortOrder(order, numRecords, records, numAttrs, keyOffset, attrType, descending);
+
+  SpillFile run(numAttrs);
+  for (int i = 0; i < numRecords; i++) {
+    int ret = run.append(&records[(size_t)order[i] * numAttrs]);
+    if (ret != SUCCESS) {
+      run.release();
+      return ret;
+    }
+  }
+  runs.push_back(run);
+  records.clear();
+  return SUCCESS;
+}
+
+int ExternalSort::add(Attribute *record) {
+  records.insert(records.end(), record, record + numAttrs);
+  if ((int)(records.size() / numAttrs) >= maxRecords)
+    return writeRun();
+  return SUCCESS;
+}
+
+/* reads the first record of every run and plays the matches of the tournament tree */
+void ExternalSort::startMerge(int first, int count) {
+  mergeFirst = first;
+  mergeCount = count;
+  heads.assign((size_t)count * numAttrs, Attribute());
+  exhausted.assign(count, 0);
+  for (int i = 0; i < count; i++) {
+    runs[first + i].rewind();
+    exhausted[i] = runs[first + i].read(&heads[(size_t)i * numAttrs]) != SUCCESS;
+  }
+
+  // the runs are the leaves count .. 2 * count - 1 of the tree and node n plays
+  // the winners of nodes 2n and 2n + 1; the loser stays at n, the winner moves up
+  std::vector<int> winner(2 * count);
+  for (int i = 0; i < count; i++)
+    winner[count + i] = i;
+  tree.assign(count, 0);
+  for (int n = count - 1; n >= 1; n--) {
+    int a = winner[2 * n], b = winner[2 * n + 1];
+    winner[n] = beats(b, a) ? b : a;
+    tree[n] = beats(b, a) ? a : b;
+  }
+  tree[0] = winner[1];
+}
+
+/* the next record of the merge; only the matches on the path of the run it came
+   from are played again */
+int ExternalSort::mergeNext(Attribute *record) {
+  int run = tree[0];
+  if (exhausted[run])
+    return E_NOTFOUND;
+
+  memcpy(record, &heads[(size_t)run * numAttrs], numAttrs * sizeof(Attribute));
+  exhausted[run] = runs[mergeFirst + run].read(&heads[(size_t)run * numAttrs]) != SUCCESS;
+
+  for (int n = (mergeCount + run) / 2; n >= 1; n /= 2) {
+    if (beats(tree[n], run))
+      std::swap(tree[n], run);
+  }
+  tree[0] = run;
+  return SUCCESS;
+}
+
+/* call once every record has been added; next() returns them in order afterwards */
+int ExternalSort::sort() {
+  if (runs.empty()) {
+    inMemory = true;
+    nextRecord = 0;
+    sortOrder(order, records.size() / numAttrs, records, numAttrs, keyOffset, attrType, descending);
+    return SUCCESS;
+  }
+
+  int ret = SUCCESS;
+  if (!records.empty())
+    ret = writeRun();
+  if (ret != SUCCESS)
+    return ret;
+  std::vector<Attribute>().swap(records);
+
+  // merge groups of MAX_MERGE_FANIN runs into longer runs until one merge is enough
+  Attribute record[numAttrs];
+  while ((int)runs.size() > MAX_MERGE_FANIN) {
+    std::vector<SpillFile> merged;
+    for (int first = 0; first < (int)runs.size(); first += MAX_MERGE_FANIN) {
+      int count = std::min(MAX_MERGE_FANIN, (int)runs.size() - first);
+      SpillFile run(numAttrs);
+      startMerge(first, count);
+      while (ret == SUCCESS && mergeNext(record) == SUCCESS)
+        ret = run.append(record);
+      for (int i = first; i < first + count; i++)
+        runs[i].release();
+      merged.push_back(run);
+      if (ret != SUCCESS) {
+        for (int i = first + count; i < (int)runs.size(); i++)
+          runs[i].release();
+        runs = merged;
+        return ret;
+      }
+    }
+    runs = merged;
+  }
+
+  inMemory = false;
+  startMerge(0, runs.size());
+  return SUCCESS;
+}
+
+/* copies the next record in order into *record. Returns E_NOTFOUND after the last one */
+int ExternalSort::next(Attribute *record) {
+  if (!inMemory)
+    return mergeNext(record);
+
+  if (nextRecord >= (int)order.size())
+    return E_NOTFOUND;
+  memcpy(record, &records[(size_t)order[nextRecord] * numAttrs], numAttrs * sizeof(Attribute));
+  nextRecord++;
+  return SUCCESS;
+}
+
+int ExternalSort::getNumRuns() {
+  return runs.size();
+}
+
+/* gives back the blocks of the runs and the memory of the records */
+void ExternalSort::release() {
+  for (int i = 0; i < (int)runs.size(); i++)
+    runs[i].release();
+  runs.clear();
+  std::vector<Attribute>().swap(records);
+  order.clear();
+  heads.clear();
+  exhausted.clear();
+  tree.clear();
+  inMemory = false;
+  mergeCount = 0;
+}
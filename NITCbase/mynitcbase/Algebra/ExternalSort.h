@@ -0,0 +1,59 @@
+#ifndef NITCBASE_EXTERNALSORT_H
+#define NITCBASE_EXTERNALSORT_H
+
+#include <vector>
+
+#include "../BlockAccess/SpillFile.h"
+#include "../define/constants.h"
+
+/*
+Sorts records of numAttrs attributes on the attribute at keyOffset, using at
+most memoryBlocks blocks of memory for records. The records are given one at a
+time with add(); whenever the memory is full they are sorted and written out as
+a run (a SpillFile). After sort() the records come back in order from next(),
+read straight from memory if no run was written, and otherwise by merging the
+runs with a tournament tree (in several passes if there are more than
+MAX_MERGE_FANIN of them). Records with equal keys keep the order they were
+added in. release() must be called when the sorter is no longer needed.
+*/
+class ExternalSort {
+ private:
+  int numAttrs;
+  int keyOffset;
+  int attrType;
+  bool descending;
+  int maxRecords;
+
+  // records not written to a run yet, and their order once sorted
+  std::vector<Attribute> records;
+  std::vector<int> order;
+  int nextRecord;
+  bool inMemory;
+
+  std::vector<SpillFile> runs;
+
+  // state of the merge of runs[mergeFirst .. mergeFirst + mergeCount - 1]:
+  // the current record of every run, whether the run is used up, and the
+  // tournament tree (tree[0] is the winner, tree[1..] the losers of each match)
+  int mergeFirst;
+  int mergeCount;
+  std::vector<Attribute> heads;
+  std::vector<char> exhausted;
+  std::vector<int> tree;
+
+  int compareRecords(Attribute *record1, Attribute *record2);
+  bool beats(int run1, int run2);
+  int writeRun();
+  void startMerge(int first, int count);
+  int mergeNext(Attribute *record);
+
+ public:
+  ExternalSort(int numAttrs, int keyOffset, int attrType, bool descending, int memoryBlocks);
+  int add(Attribute *record);
+  int sort();
+  int next(Attribute *record);
+  int getNumRuns();
+  void release();
+};
+
+#endif  // NITCBASE_EXTERNALSORT_H
@@ -0,0 +1,547 @@
+#include "Operators.h"
+#include "../BlockAccess/BlockAccess.h"
+#include "../Cache/RelCacheTable.h"
+#include <cmath>
+#include <cstring>
+
+/*
+Hash of an attribute value (FNV-1a over its bytes with a final mix, so that the
+low bits used for the buckets of a hash table and the high bits used to pick a
+disk partition both depend on the whole value). Values that compareAttrs()
+finds equal hash alike.
+*/
+uint64_t hashAttr(Attribute attr, int attrType) {
+  uint64_t hash = 1469598103934665603ULL;
+  if (attrType == NUMBER) {
+    // 0.0 and -0.0 are equal but differ in their sign bit
+    double value = attr.nVal == 0 ? 0.0 : attr.nVal;
+    unsigned char bytes[sizeof(double)];
+    memcpy(bytes, &value, sizeof(double));
+    for (int i = 0; i < (int)sizeof(double); i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  } else {
+    for (int i = 0; i < ATTR_SIZE && attr.sVal[i] != '\0'; i++) {
+      hash ^= (unsigned char)attr.sVal[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/* the attributes of relation relId, in the order of their offsets */
+static std::vector<OperatorAttr> relationAttrs(int relId) {
+  RelCatEntry relCatEntry;
+  RelCacheTable::getRelCatEntry(relId, &relCatEntry);
+  std::vector<OperatorAttr> attrs(relCatEntry.numAttrs);
+  for (int i = 0; i < relCatEntry.numAttrs; i++) {
+    AttrCatEntry attrCatEntry;
+    AttrCacheTable::getAttrCatEntry(relId, i, &attrCatEntry);
+    strcpy(attrs[i].name, attrCatEntry.attrName);
+    attrs[i].type = attrCatEntry.attrType;
+  }
+  return attrs;
+}
+
+/* the attributes of a join: those of the left input followed by those of the
+   right one except its join attribute */
+static std::vector<OperatorAttr> joinAttrs(const std::vector<OperatorAttr> &left,
+                                           const std::vector<OperatorAttr> &right, int rightKey) {
+  std::vector<OperatorAttr> attrs(left);
+  for (int i = 0; i < (int)right.size(); i++) {
+    if (i != rightKey)
+      attrs.push_back(right[i]);
+  }
+  return attrs;
+}
+
+/* the record of the join of leftRecord and rightRecord (see joinAttrs()) */
+static void joinRecords(Attribute *target, Attribute *leftRecord, int numLeftAttrs, Attribute *rightRecord,
+                        int numRightAttrs, int rightKey) {
+  int j = 0;
+  for (int i = 0; i < numLeftAttrs; i++)
+    target[j++] = leftRecord[i];
+  for (int i = 0; i < numRightAttrs; i++) {
+    if (i != rightKey)
+      target[j++] = rightRecord[i];
+  }
+}
+
+int Operator::getNumAttrs() {
+  return attrs.size();
+}
+
+const std::vector<OperatorAttr> &Operator::getAttrs() {
+  return attrs;
+}
+
+int Operator::getAttrOffset(const char *attrName) {
+  for (int i = 0; i < (int)attrs.size(); i++) {
+    if (strcmp(attrs[i].name, attrName) == 0)
+      return i;
+  }
+  return E_ATTRNOTEXIST;
+}
+
+RelationScan::RelationScan(int relId) {
+  this->relId = relId;
+  this->attrs = relationAttrs(relId);
+}
+
+int RelationScan::open() {
+  RelCacheTable::resetSearchIndex(relId);
+  return SUCCESS;
+}
+
+int RelationScan::next(Attribute *record) {
+  return BlockAccess::project(relId, record);
+}
+
+void RelationScan::close() {}
+
+SelectScan::SelectScan(int relId, char attrName[ATTR_SIZE], Attribute attrVal, int op) {
+  this->relId = relId;
+  strcpy(this->attrName, attrName);
+  this->attrVal = attrVal;
+  this->op = op;
+  this->attrs = relationAttrs(relId);
+}
+
+int SelectScan::open() {
+  // both search indices, as BlockAccess::search() does a linear or a B+ tree search
+  RelCacheTable::resetSearchIndex(relId);
+  AttrCacheTable::resetSearchIndex(relId, attrName);
+  return SUCCESS;
+}
+
+int SelectScan::next(Attribute *record) {
+  return BlockAccess::search(relId, record, attrName, attrVal, op);
+}
+
+void SelectScan::close() {}
+
+IndexOrderScan::IndexOrderScan(int relId, AttrCatEntry *attrCatEntry) {
+  this->relId = relId;
+  strcpy(this->attrName, attrCatEntry->attrName);
+  // a search for every value >= the smallest one walks the whole leaf chain
+  if (attrCatEntry->attrType == NUMBER)
+    minVal.nVal = -HUGE_VAL;
+  else
+    memset(minVal.sVal, 0, ATTR_SIZE);
+  this->attrs = relationAttrs(relId);
+}
+
+int IndexOrderScan::open() {
+  RelCacheTable::resetSearchIndex(relId);
+  AttrCacheTable::resetSearchIndex(relId, attrName);
+  return SUCCESS;
+}
+
+int IndexOrderScan::next(Attribute *record) {
+  return BlockAccess::search(relId, record, attrName, minVal, GE);
+}
+
+void IndexOrderScan::close() {}
+
+SpillScan::SpillScan(SpillFile *file, const std::vector<OperatorAttr> &attrs) {
+  this->file = file;
+  this->attrs = attrs;
+}
+
+int SpillScan::open() {
+  file->rewind();
+  return SUCCESS;
+}
+
+int SpillScan::next(Attribute *record) {
+  return file->read(record);
+}
+
+void SpillScan::close() {}
+
+Project::Project(std::unique_ptr<Operator> child, const std::vector<int> &offsets)
+    : child(std::move(child)), offsets(offsets) {
+  for (int i = 0; i < (int)offsets.size(); i++)
+    this->attrs.push_back(this->child->getAttrs()[offsets[i]]);
+  this->childRecord.resize(this->child->getNumAttrs());
+}
+
+int Project::open() {
+  return child->open();
+}
+
+int Project::next(Attribute *record) {
+  int ret = child->next(childRecord.data());
+  if (ret != SUCCESS)
+    return ret;
+  for (int i = 0; i < (int)offsets.size(); i++)
+    record[i] = childRecord[offsets[i]];
+  return SUCCESS;
+}
+
+void Project::close() {
+  child->close();
+}
+
+Sort::Sort(std::unique_ptr<Operator> child, int keyOffset, bool descending, int memoryBlocks)
+    : child(std::move(child)),
+      sorter(this->child->getNumAttrs(), keyOffset, this->child->getAttrs()[keyOffset].type, descending,
+             memoryBlocks) {
+  this->attrs = this->child->getAttrs();
+}
+
+// a sort has to see every record of its input before it returns the first one
+int Sort::open() {
+  int ret = child->open();
+  Attribute record[child->getNumAttrs()];
+  while (ret == SUCCESS && (ret = child->next(record)) == SUCCESS)
+    ret = sorter.add(record);
+  if (ret != E_NOTFOUND)
+    return ret;
+  return sorter.sort();
+}
+
+int Sort::next(Attribute *record) {
+  return sorter.next(record);
+}
+
+void Sort::close() {
+  sorter.release();
+  child->close();
+}
+
+IndexJoin::IndexJoin(std::unique_ptr<Operator> left, int leftOffset, int rightRelId, AttrCatEntry *rightAttr)
+    : left(std::move(left)), leftOffset(leftOffset), rightRelId(rightRelId), rightAttr(*rightAttr) {
+  std::vector<OperatorAttr> rightAttrs = relationAttrs(rightRelId);
+  this->attrs = joinAttrs(this->left->getAttrs(), rightAttrs, rightAttr->offset);
+  this->leftRecord.resize(this->left->getNumAttrs());
+  this->rightRecord.resize(rightAttrs.size());
+  this->hasLeft = false;
+}
+
+int IndexJoin::open() {
+  hasLeft = false;
+  return left->open();
+}
+
+int IndexJoin::next(Attribute *record) {
+  while (true) {
+    if (hasLeft && BlockAccess::search(rightRelId, rightRecord.data(), rightAttr.attrName, leftRecord[leftOffset],
+                                       EQ) == SUCCESS) {
+      joinRecords(record, leftRecord.data(), leftRecord.size(), rightRecord.data(), rightRecord.size(),
+                  rightAttr.offset);
+      return SUCCESS;
+    }
+
+    // look up the matches of the next record of the left input from the start
+    int ret = left->next(leftRecord.data());
+    hasLeft = ret == SUCCESS;
+    if (ret != SUCCESS)
+      return ret;
+    RelCacheTable::resetSearchIndex(rightRelId);
+    AttrCacheTable::resetSearchIndex(rightRelId, rightAttr.attrName);
+  }
+}
+
+void IndexJoin::close() {
+  left->close();
+}
+
+/*
+The records are stored one after another in a single array and chained by
+bucket, so adding a record costs no allocation of its own. build() must be
+called after the last add() and before the first lookup.
+*/
+JoinHashTable::JoinHashTable(int numAttrs, int keyOffset, int attrType) {
+  this->numAttrs = numAttrs;
+  this->keyOffset = keyOffset;
+  this->attrType = attrType;
+}
+
+void JoinHashTable::add(Attribute *record, uint64_t hash) {
+  records.insert(records.end(), record, record + numAttrs);
+  hashes.push_back(hash);
+}
+
+void JoinHashTable::build() {
+  int numBuckets = 16;
+  while (numBuckets < 2 * (int)hashes.size())
+    numBuckets *= 2;
+  buckets.assign(numBuckets, -1);
+  chain.assign(hashes.size(), -1);
+  for (int i = 0; i < (int)hashes.size(); i++) {
+    int bucket = hashes[i] & (numBuckets - 1);
+    chain[i] = buckets[bucket];
+    buckets[bucket] = i;
+  }
+}
+
+// the first entry of the chain of the bucket of hash
+int JoinHashTable::first(uint64_t hash) {
+  if (buckets.empty())
+    return -1;
+  return buckets[hash & (buckets.size() - 1)];
+}
+
+// the first entry from entry on along its chain whose key equals key, -1 if there is none
+int JoinHashTable::match(int entry, Attribute key, uint64_t hash) {
+  for (int i = entry; i != -1; i = chain[i]) {
+    if (hashes[i] == hash && compareAttrs(records[(size_t)i * numAttrs + keyOffset], key, attrType) == 0)
+      return i;
+  }
+  return -1;
+}
+
+int JoinHashTable::next(int entry) {
+  return chain[entry];
+}
+
+Attribute *JoinHashTable::record(int entry) {
+  return &records[(size_t)entry * numAttrs];
+}
+
+long long JoinHashTable::getBytes() {
+  return (long long)records.size() * sizeof(Attribute);
+}
+
+void JoinHashTable::clear() {
+  std::vector<Attribute>().swap(records);
+  hashes.clear();
+  chain.clear();
+  buckets.clear();
+}
+
+HashJoin::HashJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, int leftKey, int rightKey,
+                   bool leftIsBuild)
+    : build(leftIsBuild ? std::move(left) : std::move(right)),
+      probe(leftIsBuild ? std::move(right) : std::move(left)),
+      leftIsBuild(leftIsBuild),
+      buildKey(leftIsBuild ? leftKey : rightKey),
+      probeKey(leftIsBuild ? rightKey : leftKey),
+      rightKey(rightKey),
+      attrType(build->getAttrs()[buildKey].type),
+      numBuildAttrs(build->getNumAttrs()),
+      numProbeAttrs(probe->getNumAttrs()),
+      table(numBuildAttrs, buildKey, attrType) {
+  if (leftIsBuild)
+    this->attrs = joinAttrs(build->getAttrs(), probe->getAttrs(), rightKey);
+  else
+    this->attrs = joinAttrs(probe->getAttrs(), build->getAttrs(), rightKey);
+  this->probeRecord.resize(numProbeAttrs);
+  this->partition = -1;
+  this->entry = -1;
+}
+
+/* moves the records in the table to partitions, the high bits of the hash
+   picking the partition (the table uses the low ones) */
+int HashJoin::partitionAll() {
+  buildParts.assign(MAX_JOIN_PARTITIONS, SpillFile(numBuildAttrs));
+  probeParts.assign(MAX_JOIN_PARTITIONS, SpillFile(numProbeAttrs));
+  int numRecords = table.getBytes() / ((long long)numBuildAttrs * sizeof(Attribute));
+  for (int i = 0; i < numRecords; i++) {
+    Attribute *record = table.record(i);
+    int ret = buildParts[(hashAttr(record[buildKey], attrType) >> 32) % MAX_JOIN_PARTITIONS].append(record);
+    if (ret != SUCCESS)
+      return ret;
+  }
+  table.clear();
+  return SUCCESS;
+}
+
+int HashJoin::open() {
+  partition = -1;
+  entry = -1;
+
+  int ret = build->open();
+  if (ret != SUCCESS)
+    return ret;
+  Attribute record[numBuildAttrs];
+  long long memoryBytes = (long long)JOIN_MEMORY_BLOCKS * BLOCK_SIZE;
+  while ((ret = build->next(record)) == SUCCESS) {
+    uint64_t hash = hashAttr(record[buildKey], attrType);
+    if (!buildParts.empty())
+      ret = buildParts[(hash >> 32) % MAX_JOIN_PARTITIONS].append(record);
+    else {
+      table.add(record, hash);
+      // the build side does not fit in memory: partition both sides
+      if (table.getBytes() > memoryBytes)
+        ret = partitionAll();
+    }
+    if (ret != SUCCESS)
+      return ret;
+  }
+  if (ret != E_NOTFOUND)
+    return ret;
+
+  ret = probe->open();
+  if (ret != SUCCESS || buildParts.empty()) {
+    table.build();
+    return ret;
+  }
+
+  while ((ret = probe->next(probeRecord.data())) == SUCCESS) {
+    ret = probeParts[(hashAttr(probeRecord[probeKey], attrType) >> 32) % MAX_JOIN_PARTITIONS].append(
+        probeRecord.data());
+    if (ret != SUCCESS)
+      return ret;
+  }
+  return ret == E_NOTFOUND ? SUCCESS : ret;
+}
+
+/* reads the next record of the probe side into probeRecord; once partitioned,
+   moves on to the next pair of partitions (with records on both sides) when
+   the probe partition is used up, loading its build partition into the table */
+int HashJoin::readProbe() {
+  if (buildParts.empty())
+    return probe->next(probeRecord.data());
+
+  int numPartitions = buildParts.size();
+  while (partition < numPartitions) {
+    if (partition >= 0 && probeParts[partition].read(probeRecord.data()) == SUCCESS)
+      return SUCCESS;
+
+    if (partition >= 0) {
+      buildParts[partition].release();
+      probeParts[partition].release();
+    }
+    partition++;
+    while (partition < numPartitions &&
+           (buildParts[partition].getNumRecords() == 0 || probeParts[partition].getNumRecords() == 0)) {
+      buildParts[partition].release();
+      probeParts[partition].release();
+      partition++;
+    }
+    if (partition == numPartitions)
+      break;
+
+    // (a partition can still be larger than the memory budget when many
+    // records share a key; it is joined in memory anyway)
+    table.clear();
+    Attribute record[numBuildAttrs];
+    buildParts[partition].rewind();
+    while (buildParts[partition].read(record) == SUCCESS)
+      table.add(record, hashAttr(record[buildKey], attrType));
+    table.build();
+    probeParts[partition].rewind();
+  }
+  return E_NOTFOUND;
+}
+
+int HashJoin::next(Attribute *record) {
+  while (true) {
+    Attribute key = probeRecord[probeKey];
+    int found = entry == -1 ? -1 : table.match(entry, key, probeHash);
+    if (found != -1) {
+      entry = table.next(found);
+      if (leftIsBuild)
+        joinRecords(record, table.record(found), numBuildAttrs, probeRecord.data(), numProbeAttrs, rightKey);
+      else
+        joinRecords(record, probeRecord.data(), numProbeAttrs, table.record(found), numBuildAttrs, rightKey);
+      return SUCCESS;
+    }
+
+    int ret = readProbe();
+    if (ret != SUCCESS)
+      return ret;
+    probeHash = hashAttr(probeRecord[probeKey], attrType);
+    entry = table.first(probeHash);
+  }
+}
+
+void HashJoin::close() {
+  for (int p = 0; p < (int)buildParts.size(); p++) {
+    buildParts[p].release();
+    probeParts[p].release();
+  }
+  buildParts.clear();
+  probeParts.clear();
+  table.clear();
+  build->close();
+  probe->close();
+}
+
+MergeJoin::MergeJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, int leftKey, int rightKey)
+    : left(std::move(left)), right(std::move(right)), leftKey(leftKey), rightKey(rightKey) {
+  this->attrType = this->left->getAttrs()[leftKey].type;
+  this->numLeftAttrs = this->left->getNumAttrs();
+  this->numRightAttrs = this->right->getNumAttrs();
+  this->attrs = joinAttrs(this->left->getAttrs(), this->right->getAttrs(), rightKey);
+  this->leftRecord.resize(numLeftAttrs);
+  this->rightRecord.resize(numRightAttrs);
+  this->hasLeft = false;
+  this->hasRight = false;
+  this->groupPos = 0;
+  this->inGroup = false;
+}
+
+int MergeJoin::open() {
+  inGroup = false;
+  int ret = left->open();
+  if (ret == SUCCESS)
+    ret = right->open();
+  if (ret == SUCCESS && (ret = left->next(leftRecord.data())) == SUCCESS)
+    ret = right->next(rightRecord.data());
+  hasLeft = hasRight = ret == SUCCESS;
+  return ret == E_NOTFOUND ? SUCCESS : ret;
+}
+
+int MergeJoin::next(Attribute *record) {
+  int ret;
+  while (true) {
+    if (inGroup) {
+      int groupSize = group.size() / numRightAttrs;
+      if (groupPos < groupSize) {
+        joinRecords(record, leftRecord.data(), numLeftAttrs, &group[(size_t)groupPos * numRightAttrs],
+                    numRightAttrs, rightKey);
+        groupPos++;
+        return SUCCESS;
+      }
+
+      // the next record of the left input may have the same key
+      ret = left->next(leftRecord.data());
+      if (ret != SUCCESS && ret != E_NOTFOUND)
+        return ret;
+      hasLeft = ret == SUCCESS;
+      groupPos = 0;
+      if (hasLeft && compareAttrs(leftRecord[leftKey], group[rightKey], attrType) == 0)
+        continue;
+      inGroup = false;
+    }
+
+    if (!hasLeft || !hasRight)
+      return E_NOTFOUND;
+
+    int cmp = compareAttrs(leftRecord[leftKey], rightRecord[rightKey], attrType);
+    if (cmp < 0) {
+      ret = left->next(leftRecord.data());
+      hasLeft = ret == SUCCESS;
+    } else if (cmp > 0) {
+      ret = right->next(rightRecord.data());
+      hasRight = ret == SUCCESS;
+    } else {
+      // collect the records of the right input with this key
+      Attribute key = rightRecord[rightKey];
+      group.clear();
+      ret = SUCCESS;
+      while (hasRight && compareAttrs(rightRecord[rightKey], key, attrType) == 0) {
+        group.insert(group.end(), rightRecord.begin(), rightRecord.end());
+        ret = right->next(rightRecord.data());
+        hasRight = ret == SUCCESS;
+      }
+      inGroup = true;
+      groupPos = 0;
+    }
+    if (ret != SUCCESS && ret != E_NOTFOUND)
+      return ret;
+  }
+}
+
+void MergeJoin::close() {
+  group.clear();
+  left->close();
+  right->close();
+}
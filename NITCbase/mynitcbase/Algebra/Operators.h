@@ -0,0 +1,251 @@
+#ifndef NITCBASE_OPERATORS_H
+#define NITCBASE_OPERATORS_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ExternalSort.h"
+#include "../BlockAccess/SpillFile.h"
+#include "../Cache/AttrCacheTable.h"
+#include "../define/constants.h"
+
+/* name and type of an attribute of the records returned by an operator */
+struct OperatorAttr {
+  char name[ATTR_SIZE];
+  int type;
+};
+
+/*
+An operator of a query plan, in the iterator style: open() prepares it, every
+next() returns one record of its result and close() frees what it holds. An
+operator pulls the records it needs from the operators below it one at a time,
+so a plan of several operators (e.g. a projection of a join) writes no
+intermediate relation; the records of the top operator are the only ones stored
+(see Algebra's materialize()). Operators own the operators below them.
+*/
+class Operator {
+ protected:
+  std::vector<OperatorAttr> attrs;
+
+ public:
+  virtual ~Operator() {}
+  virtual int open() = 0;
+  // copies the next record into record; E_NOTFOUND once there are no more
+  virtual int next(Attribute *record) = 0;
+  virtual void close() = 0;
+
+  int getNumAttrs();
+  const std::vector<OperatorAttr> &getAttrs();
+  // index of the attribute attrName in the records returned, E_ATTRNOTEXIST if there is none
+  int getAttrOffset(const char *attrName);
+};
+
+/* every record of a relation, in the order they are stored */
+class RelationScan : public Operator {
+ private:
+  int relId;
+
+ public:
+  RelationScan(int relId);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/* the records of a relation that satisfy `attr op attrVal`, found through the
+   index on attr when there is one (BlockAccess::search()) */
+class SelectScan : public Operator {
+ private:
+  int relId;
+  char attrName[ATTR_SIZE];
+  Attribute attrVal;
+  int op;
+
+ public:
+  SelectScan(int relId, char attrName[ATTR_SIZE], Attribute attrVal, int op);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/* the records of a relation in ascending order of an indexed attribute, read
+   along the leaf chain of its index */
+class IndexOrderScan : public Operator {
+ private:
+  int relId;
+  char attrName[ATTR_SIZE];
+  Attribute minVal;
+
+ public:
+  IndexOrderScan(int relId, AttrCatEntry *attrCatEntry);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/* the records of a spill file (written by an operator with the schema attrs) */
+class SpillScan : public Operator {
+ private:
+  SpillFile *file;
+
+ public:
+  SpillScan(SpillFile *file, const std::vector<OperatorAttr> &attrs);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/* the attributes at offsets of every record of child, in that order */
+class Project : public Operator {
+ private:
+  std::unique_ptr<Operator> child;
+  std::vector<int> offsets;
+  std::vector<Attribute> childRecord;
+
+ public:
+  Project(std::unique_ptr<Operator> child, const std::vector<int> &offsets);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/* the records of child in ascending (or descending) order of the attribute at
+   keyOffset, through an external sort; equal keys keep the order of child */
+class Sort : public Operator {
+ private:
+  std::unique_ptr<Operator> child;
+  ExternalSort sorter;
+
+ public:
+  Sort(std::unique_ptr<Operator> child, int keyOffset, bool descending, int memoryBlocks);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/*
+The joins below return the records of the left input joined with the matching
+records of the right one: the attributes of the left record followed by those
+of the right record except its join attribute.
+*/
+
+/* nested loop join that looks up the matching records of relation rightRelId
+   with BlockAccess::search() on its (indexed) join attribute */
+class IndexJoin : public Operator {
+ private:
+  std::unique_ptr<Operator> left;
+  int leftOffset;
+  int rightRelId;
+  AttrCatEntry rightAttr;
+  std::vector<Attribute> leftRecord;
+  std::vector<Attribute> rightRecord;
+  bool hasLeft;
+
+ public:
+  IndexJoin(std::unique_ptr<Operator> left, int leftOffset, int rightRelId, AttrCatEntry *rightAttr);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/* in-memory hash table over the records of the build side of a hash join */
+class JoinHashTable {
+ private:
+  int numAttrs;
+  int keyOffset;
+  int attrType;
+  std::vector<Attribute> records;
+  std::vector<uint64_t> hashes;
+  std::vector<int> chain;
+  std::vector<int> buckets;
+
+ public:
+  JoinHashTable(int numAttrs, int keyOffset, int attrType);
+  void add(Attribute *record, uint64_t hash);
+  void build();
+  int first(uint64_t hash);
+  int match(int entry, Attribute key, uint64_t hash);
+  int next(int entry);
+  Attribute *record(int entry);
+  long long getBytes();
+  void clear();
+};
+
+/*
+Hash join: open() loads the build side (leftIsBuild picks the left or the right
+input) into a hash table on its join attribute, and next() reads the probe side
+one record at a time, returning its matches in the table. If the build side
+grows larger than JOIN_MEMORY_BLOCKS blocks, both sides are split into
+partitions written to spill files by the hash of their join attribute and the
+partitions are joined one pair at a time.
+*/
+class HashJoin : public Operator {
+ private:
+  std::unique_ptr<Operator> build;
+  std::unique_ptr<Operator> probe;
+  bool leftIsBuild;
+  int buildKey;
+  int probeKey;
+  int rightKey;
+  int attrType;
+  int numBuildAttrs;
+  int numProbeAttrs;
+
+  JoinHashTable table;
+  std::vector<SpillFile> buildParts;
+  std::vector<SpillFile> probeParts;
+  // partition being joined (-1 while the probe side is read from its operator)
+  int partition;
+
+  std::vector<Attribute> probeRecord;
+  uint64_t probeHash;
+  // next entry of the table to check against probeRecord (-1 when a new probe record is needed)
+  int entry;
+
+  int readProbe();
+  int partitionAll();
+
+ public:
+  HashJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, int leftKey, int rightKey,
+           bool leftIsBuild);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+/*
+Sort-merge join of two inputs that return their records in ascending order of
+their join attributes (an IndexOrderScan or a Sort). All the records of the
+right input with the current key are kept in memory while the records of the
+left input with that key are joined with them.
+*/
+class MergeJoin : public Operator {
+ private:
+  std::unique_ptr<Operator> left;
+  std::unique_ptr<Operator> right;
+  int leftKey;
+  int rightKey;
+  int attrType;
+  int numLeftAttrs;
+  int numRightAttrs;
+
+  std::vector<Attribute> leftRecord;
+  std::vector<Attribute> rightRecord;
+  bool hasLeft;
+  bool hasRight;
+  // records of the right input with the key of leftRecord, and the next one to join with it
+  std::vector<Attribute> group;
+  int groupPos;
+  bool inGroup;
+
+ public:
+  MergeJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right, int leftKey, int rightKey);
+  int open();
+  int next(Attribute *record);
+  void close();
+};
+
+uint64_t hashAttr(Attribute attr, int attrType);
+
+#endif  // NITCBASE_OPERATORS_H
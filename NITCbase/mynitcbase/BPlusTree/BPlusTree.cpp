@@ -1,6 +1,18 @@
 #include "BPlusTree.h"
 #include<cstdio>
+#include <algorithm>
 #include <cstring>
+#include <vector>
+
+// how internal blocks of an index on an attribute of attrType store their entries
+static int internalLayout(int attrType) {
+    return attrType == NUMBER ? INTERNAL_LAYOUT_NUMBER : INTERNAL_LAYOUT_INTERLEAVED;
+}
+
+// how new leaf blocks of an index on an attribute of attrType store their entries
+static int leafLayout(int attrType) {
+    return (attrType == STRING && PREFIX_COMPRESS_STRING_LEAVES) ? LEAF_LAYOUT_PREFIX : LEAF_LAYOUT_PLAIN;
+}
 
 RecId BPlusTree::bPlusSearch(int relId, char attrName[ATTR_SIZE], Attribute attrVal, int op)
 {
@@ -16,6 +28,9 @@ RecId BPlusTree::bPlusSearch(int relId, char attrName[ATTR_SIZE], Attribute attr
      AttrCacheTable::getAttrCatEntry(). */
     AttrCacheTable::getAttrCatEntry(relId,attrName,&attrCatEntry);
 
+    // the keys in the tree are normalized (see normalizeKey())
+    normalizeKey(&attrVal, attrCatEntry.attrType);
+
     // declare variables block and index which will be used during search
     int block, index;
 
@@ -73,8 +88,10 @@ RecId BPlusTree::bPlusSearch(int relId, char attrName[ATTR_SIZE], Attribute attr
 
     while(StaticBuffer::getStaticBlockType(block) == IND_INTERNAL) {  //use StaticBuffer::getStaticBlockType()
 
-        // load the block into internalBlk using IndInternal::IndInternal().
+        // load the block into internalBlk using IndInternal::IndInternal()
+        // and keep it pinned while its entries are read
         IndInternal internalBlk(block);
+        PageGuard internalGuard(internalBlk);
 
         HeadInfo intHead;
 
@@ -114,22 +131,14 @@ RecId BPlusTree::bPlusSearch(int relId, char attrName[ATTR_SIZE], Attribute attr
             */
 
             /*
-             traverse through all entries of internalBlk and find an entry that
-             satisfies the condition.
+             find the first entry that satisfies the condition by a binary
+             search over the sorted keys of the node:
              if op == EQ or GE, then intEntry.attrVal >= attrVal
              if op == GT, then intEntry.attrVal > attrVal
-             Hint: the helper function compareAttrs() can be used for comparing
             */
-            int i;
-            for(i=0; i<intHead.numEntries;i++)
-            {
-                internalBlk.getEntry(&intEntry,i);
-                if((op==GE || op==EQ) && compareAttrs(intEntry.attrVal,attrVal,attrCatEntry.attrType)>=0)
-                    break;
-                if(op==GT && compareAttrs(intEntry.attrVal,attrVal,attrCatEntry.attrType)>0)
-                    break;
-
-            }
+            int i = internalBlk.lowerBound(attrVal, attrCatEntry.attrType, op == GT);
+            if (i != intHead.numEntries)
+                internalBlk.getEntry(&intEntry, i);
 
             if (i != intHead.numEntries)
             {
@@ -154,13 +163,20 @@ RecId BPlusTree::bPlusSearch(int relId, char attrName[ATTR_SIZE], Attribute attr
                 that satisfies our condition (moving right)             ******/
 
     while (block != -1) {
-        // load the block into leafBlk using IndLeaf::IndLeaf().
+        // load the block into leafBlk using IndLeaf::IndLeaf()
+        // and keep it pinned while its entries are read
         IndLeaf leafBlk(block);
+        PageGuard leafGuard(leafBlk);
         HeadInfo leafHead;
 
         // load the header to leafHead using BlockBuffer::getHeader().
         leafBlk.getHeader(&leafHead);
 
+        // on a new search, skip straight to the first entry that can satisfy
+        // EQ, GE or GT instead of comparing every entry from the start
+        if (index == 0 && (op == EQ || op == GE || op == GT))
+            index = leafBlk.lowerBound(attrVal, attrCatEntry.attrType, op == GT);
+
         // declare leafEntry which will be used to store an entry from leafBlk
         Index leafEntry;
 
@@ -170,8 +186,8 @@ RecId BPlusTree::bPlusSearch(int relId, char attrName[ATTR_SIZE], Attribute attr
             // using IndLeaf::getEntry().
             leafBlk.getEntry(&leafEntry, index);
 
-            int cmpVal = compareAttrs(leafEntry.attrVal,attrVal,attrCatEntry.attrType);/* comparison between leafEntry's attribute value
-                            and input attrVal using compareAttrs()*/
+            int cmpVal = compareKeys(&leafEntry.attrVal,&attrVal,attrCatEntry.attrType);/* comparison between leafEntry's attribute value
+                            and input attrVal using compareKeys()*/
 
             if (
                 (op == EQ && cmpVal == 0) ||
@@ -241,23 +257,7 @@ int BPlusTree::bPlusCreate(int relId, char attrName[ATTR_SIZE]) {
         return SUCCESS;
     }
 
-    /******Creating a new B+ Tree ******/
-
-    // get a free leaf block using constructor 1 to allocate a new block
-    IndLeaf rootBlockBuf;
-
-    // (if the block could not be allocated, the appropriate error code
-    //  will be stored in the blockNum member field of the object)
-
-    // declare rootBlock to store the blockNumber of the new leaf block
-    int rootBlock = rootBlockBuf.getBlockNum();
-
-    // if there is no more disk space for creating an index
-    if (rootBlock == E_DISKFULL) {
-        return E_DISKFULL;
-    }
-    attrCatEntry.rootBlock = rootBlock;
-    AttrCacheTable::setAttrCatEntry(relId, attrName, &attrCatEntry);
+    /****** Collecting the (key, rec-id) pairs of the relation ******/
 
     RelCatEntry relCatEntry;
 
@@ -265,58 +265,250 @@ int BPlusTree::bPlusCreate(int relId, char attrName[ATTR_SIZE]) {
     // using RelCacheTable::getRelCatEntry().
     RelCacheTable::getRelCatEntry(relId,&relCatEntry);
 
-    int block = relCatEntry.firstBlk;/* first record block of the relation */
+    std::vector<Index> entries;
+    entries.reserve(relCatEntry.numRecs);
 
-    /***** Traverse all the blocks in the relation and insert them one
-           by one into the B+ Tree *****/
+    int block = relCatEntry.firstBlk;/* first record block of the relation */
     while (block != -1) {
 
-        // declare a RecBuffer object for `block` (using appropriate constructor)
+        // keep the block pinned while its records are read
         RecBuffer buffer(block);
+        PageGuard guard(buffer);
 
         unsigned char slotMap[relCatEntry.numSlotsPerBlk];
-
-        // load the slot map into slotMap using RecBuffer::getSlotMap().
         buffer.getSlotMap(slotMap);
 
-        // for every occupied slot of the block
         for(int slot=0;slot<relCatEntry.numSlotsPerBlk;slot++)
         {
             if(slotMap[slot] == SLOT_OCCUPIED)
             {
                 Attribute record[relCatEntry.numAttrs];
-                // load the record corresponding to the slot into `record`
-                // using RecBuffer::getRecord().
                 buffer.getRecord(record,slot);
 
-                // declare recId and store the rec-id of this record in it
-                // RecId recId{block, slot};
-                RecId recId = {block,slot};
-
-                // insert the attribute value corresponding to attrName from the    record
-                // into the B+ tree using bPlusInsert.
-                // (note that bPlusInsert will destroy any existing bplus tree if
-                // insert fails i.e when disk is full)
-                int retVal = bPlusInsert(relId, attrName, record[attrCatEntry.offset], recId);
-                if (retVal == E_DISKFULL)
-                {
-                     // (unable to get enough blocks to build the B+ Tree.)
-                     return E_DISKFULL;
-                }
+                Index entry;
+                entry.attrVal = record[attrCatEntry.offset];
+                normalizeKey(&entry.attrVal, attrCatEntry.attrType);
+                entry.block = block;
+                entry.slot = slot;
+                memset(entry.unused, 0, sizeof(entry.unused));
+                entries.push_back(entry);
             }
         }
 
-        // get the header of the block using BlockBuffer::getHeader()
+        // set block = rblock of current block (from the header)
         HeadInfo head;
         buffer.getHeader(&head);
-
-        // set block = rblock of current block (from the header)
         block = head.rblock;
     }
 
+    // sort by key; stable so that equal keys stay in the order of the relation
+    int attrType = attrCatEntry.attrType;
+    std::stable_sort(entries.begin(), entries.end(), [attrType](const Index &x, const Index &y) {
+        return compareKeys(&x.attrVal, &y.attrVal, attrType) < 0;
+    });
+
+    /****** Building the tree bottom-up ******/
+
+    int rootBlock = bulkBuild(entries.data(), entries.size(), attrType);
+    if (rootBlock < 0) {
+        return rootBlock;
+    }
+
+    attrCatEntry.rootBlock = rootBlock;
+    AttrCacheTable::setAttrCatEntry(relId, attrName, &attrCatEntry);
+
     return SUCCESS;
 }
 
+/*
+    Builds a B+ tree over `numEntries` leaf entries sorted by key and returns its
+    root block. Leaves are packed to BPLUS_BULK_FILL_PERCENT of MAX_KEYS_LEAF (of
+    the block for prefix leaves) and linked left to right; each internal level is then built over the level below
+    it, with the largest key of a child as the separator after it (the same key
+    splitLeaf() and splitInternal() push up). The entries of a level are spread
+    evenly over its nodes so that the last node is not left nearly empty.
+    If a block cannot be allocated, every block allocated so far is released
+    and the error (E_DISKFULL) is returned.
+*/
+int BPlusTree::bulkBuild(Index entries[], int numEntries, int attrType) {
+    std::vector<int> allocated;
+    auto fail = [&allocated](int error) {
+        for (int blockNum : allocated) {
+            BlockBuffer buffer(blockNum);
+            buffer.releaseBlock();
+        }
+        return error;
+    };
+
+    int layout = leafLayout(attrType);
+
+    // the entries of leaf i are entries[leafBounds[i] .. leafBounds[i + 1])
+    std::vector<int> leafBounds(1, 0);
+    if (layout == LEAF_LAYOUT_PREFIX) {
+        // how many keys fit in a prefix leaf depends on the keys: fill each
+        // leaf up to BPLUS_BULK_FILL_PERCENT of the block in turn
+        int maxCount = MAX_KEYS_LEAF_PREFIX * BPLUS_BULK_FILL_PERCENT / 100;
+        int maxSize = (BLOCK_SIZE - HEADER_SIZE) * BPLUS_BULK_FILL_PERCENT / 100;
+        while (leafBounds.back() < numEntries) {
+            int next = leafBounds.back();
+            // largest count whose layout is within maxSize (the size only grows with the count)
+            int low = 1, high = std::min(maxCount, numEntries - next);
+            while (low < high) {
+                int mid = (low + high + 1) / 2;
+                if (IndLeaf::prefixLayoutSize(entries + next, mid) <= maxSize)
+                    low = mid;
+                else
+                    high = mid - 1;
+            }
+            leafBounds.push_back(next + low);
+        }
+    } else {
+        int leafFill = MAX_KEYS_LEAF * BPLUS_BULK_FILL_PERCENT / 100;
+        if (leafFill < MIDDLE_INDEX_LEAF + 1)
+            leafFill = MIDDLE_INDEX_LEAF + 1;
+        if (leafFill > MAX_KEYS_LEAF)
+            leafFill = MAX_KEYS_LEAF;
+
+        // leaf i gets an even share of the remaining entries
+        int numLeaves = (numEntries + leafFill - 1) / leafFill;
+        for (int i = 0; i < numLeaves; i++) {
+            int next = leafBounds.back();
+            leafBounds.push_back(next + (numEntries - next) / (numLeaves - i));
+        }
+    }
+    if (leafBounds.size() == 1)
+        leafBounds.push_back(0);  // an empty index is a single empty leaf
+    int numLeaves = leafBounds.size() - 1;
+
+    // block number and largest key of every node of the level being built
+    std::vector<int> level(numLeaves);
+    std::vector<Attribute> maxKey(numLeaves);
+
+    for (int i = 0; i < numLeaves; i++) {
+        IndLeaf leaf;
+        int leafBlkNum = leaf.getBlockNum();
+        if (leafBlkNum < 0)
+            return fail(leafBlkNum);
+        allocated.push_back(leafBlkNum);
+        PageGuard guard(leaf);
+
+        int next = leafBounds[i + 1];
+        int count = next - leafBounds[i];
+        HeadInfo header;
+        leaf.getHeader(&header);
+        header.numEntries = count;
+        header.lblock = (i == 0) ? -1 : level[i - 1];
+        header.rblock = -1;
+        header.numSlots = layout;
+        leaf.setHeader(&header);
+
+        leaf.setEntries(entries + leafBounds[i], count);
+
+        if (count > 0)
+            maxKey[i] = entries[next - 1].attrVal;
+        level[i] = leafBlkNum;
+
+        if (i > 0) {
+            IndLeaf left(level[i - 1]);
+            HeadInfo leftHead;
+            left.getHeader(&leftHead);
+            leftHead.rblock = leafBlkNum;
+            left.setHeader(&leftHead);
+        }
+    }
+
+    int childFill = MAX_KEYS_INTERNAL * BPLUS_BULK_FILL_PERCENT / 100 + 1;
+    if (childFill < MIDDLE_INDEX_INTERNAL + 1)
+        childFill = MIDDLE_INDEX_INTERNAL + 1;
+    if (childFill > MAX_KEYS_INTERNAL + 1)
+        childFill = MAX_KEYS_INTERNAL + 1;
+
+    while (level.size() > 1) {
+        int numChildren = level.size();
+        int numNodes = (numChildren + childFill - 1) / childFill;
+        std::vector<int> parents(numNodes);
+        std::vector<Attribute> parentMaxKey(numNodes);
+
+        int child = 0;
+        for (int i = 0; i < numNodes; i++) {
+            IndInternal internal;
+            int intBlkNum = internal.getBlockNum();
+            if (intBlkNum < 0)
+                return fail(intBlkNum);
+            allocated.push_back(intBlkNum);
+            PageGuard guard(internal);
+
+            int count = (numChildren - child) / (numNodes - i);
+            HeadInfo header;
+            internal.getHeader(&header);
+            header.numEntries = count - 1;
+            header.numSlots = internalLayout(attrType);
+            internal.setHeader(&header);
+
+            for (int k = 0; k < count - 1; k++) {
+                InternalEntry entry;
+                entry.lChild = level[child + k];
+                entry.attrVal = maxKey[child + k];
+                entry.rChild = level[child + k + 1];
+                internal.setEntry(&entry, k);
+            }
+
+            // point the children at their parent
+            for (int k = 0; k < count; k++) {
+                BlockBuffer childBlk(level[child + k]);
+                HeadInfo childHead;
+                childBlk.getHeader(&childHead);
+                childHead.pblock = intBlkNum;
+                childBlk.setHeader(&childHead);
+            }
+
+            parents[i] = intBlkNum;
+            parentMaxKey[i] = maxKey[child + count - 1];
+            child += count;
+        }
+
+        level.swap(parents);
+        maxKey.swap(parentMaxKey);
+    }
+
+    // mark the root as holding normalized keys
+    BlockBuffer root(level[0]);
+    HeadInfo rootHead;
+    root.getHeader(&rootHead);
+    rootHead.numAttrs = BPLUS_KEY_FORMAT;
+    root.setHeader(&rootHead);
+
+    return level[0];
+}
+
+/*
+    Indexes created in an older format (their root does not carry
+    BPLUS_KEY_FORMAT in numAttrs) are built again: before format 1 keys were
+    not normalized and could not be searched with compareKeys(), and before
+    format 2 NUMBER internal nodes were not in INTERNAL_LAYOUT_NUMBER. Called
+    when a relation is opened.
+*/
+int BPlusTree::checkKeyFormat(int relId, char attrName[ATTR_SIZE]) {
+    AttrCatEntry attrCatEntry;
+    int ret = AttrCacheTable::getAttrCatEntry(relId,attrName,&attrCatEntry);
+    if(ret!=SUCCESS)
+        return ret;
+
+    if (attrCatEntry.rootBlock == -1)
+        return SUCCESS;
+
+    BlockBuffer root(attrCatEntry.rootBlock);
+    HeadInfo rootHead;
+    root.getHeader(&rootHead);
+    if (rootHead.numAttrs == BPLUS_KEY_FORMAT)
+        return SUCCESS;
+
+    bPlusDestroy(attrCatEntry.rootBlock);
+    attrCatEntry.rootBlock = -1;
+    AttrCacheTable::setAttrCatEntry(relId, attrName, &attrCatEntry);
+
+    return bPlusCreate(relId, attrName);
+}
 
 int BPlusTree::bPlusDestroy(int rootBlockNum) {
     if (rootBlockNum<0 || rootBlockNum>=DISK_BLOCKS) {
@@ -390,6 +582,9 @@ int BPlusTree::bPlusInsert(int relId, char attrName[ATTR_SIZE], Attribute attrVa
     // find the leaf block to which insertion is to be done using the
     // findLeafToInsert() function
 
+    // the keys in the tree are normalized (see normalizeKey())
+    normalizeKey(&attrVal, attrCatEntry.attrType);
+
     int leafBlkNum = findLeafToInsert(blockNum, attrVal, attrCatEntry.attrType);
 
     // insert the attrVal and recId to the leaf block at blockNum using the
@@ -429,23 +624,15 @@ int BPlusTree::findLeafToInsert(int rootBlock, Attribute attrVal, int attrType)
 
         // declare an IndInternal object for block using appropriate constructor
         IndInternal internal(blockNum);
+        PageGuard guard(internal);
 
         // get header of the block using BlockBuffer::getHeader()
         HeadInfo header;
         internal.getHeader(&header);
 
-        /* iterate through all the entries, to find the first entry whose
-             attribute value >= value to be inserted.
-             NOTE: the helper function compareAttrs() declared in BlockBuffer.h
-                   can be used to compare two Attribute values. */
-        int i;
-        for(i=0;i<header.numEntries;i++)
-        {
-            InternalEntry entry;
-            internal.getEntry(&entry,i);
-            if(compareAttrs(entry.attrVal,attrVal,attrType)>=0)
-                break;
-        }
+        /* binary search for the first entry whose attribute value >= value
+           to be inserted */
+        int i = internal.lowerBound(attrVal, attrType, false);
 
         if (i == header.numEntries)
         {
@@ -476,6 +663,7 @@ int BPlusTree::insertIntoLeaf(int relId, char attrName[ATTR_SIZE], int blockNum,
 
     // declare an IndLeaf instance for the block using appropriate constructor
     IndLeaf leaf(blockNum);
+    PageGuard guard(leaf);
 
     HeadInfo blockHeader;
     // store the header of the leaf index block into blockHeader
@@ -499,12 +687,8 @@ int BPlusTree::insertIntoLeaf(int relId, char attrName[ATTR_SIZE], int blockNum,
         leaf.getEntry(&indexentry,i);
         indices[i] = indexentry;
     }
-    int j;
-    for(j=0;j<blockHeader.numEntries;j++)
-    {
-        if(compareAttrs(indices[j].attrVal,indexEntry.attrVal,attrCatEntry.attrType)>0)
-            break;
-    }
+    // the new entry goes after every entry with a key <= its key
+    int j = leaf.lowerBound(indexEntry.attrVal, attrCatEntry.attrType, true);
     if(j==blockHeader.numEntries)
         indices[j] = indexEntry;
     else
@@ -516,24 +700,14 @@ int BPlusTree::insertIntoLeaf(int relId, char attrName[ATTR_SIZE], int blockNum,
         indices[j] = indexEntry;
     }
 
-    if (blockHeader.numEntries != MAX_KEYS_LEAF)
-    {
-        // (leaf block has not reached max limit)
-
-        // increment blockHeader.numEntries and update the header of block
-        // using BlockBuffer::setHeader().
-        blockHeader.numEntries+=1;
-        leaf.setHeader(&blockHeader);
-
-        // iterate through all the entries of the array `indices` and populate the
-        // entries of block with them using IndLeaf::setEntry().
-        for(int i=0;i<blockHeader.numEntries;i++)
-        {
-            leaf.setEntry(&indices[i],i);
-        }
+    int numIndices = blockHeader.numEntries + 1;
 
+    // (leaf block has room for them: MAX_KEYS_LEAF entries in a plain leaf, as
+    // many as fit in the block in a prefix leaf)
+    // write all the entries of the array `indices` back to the block, updating
+    // numEntries, using IndLeaf::setEntries().
+    if (leaf.setEntries(indices, numIndices) == SUCCESS)
         return SUCCESS;
-    }
 
     // If we reached here, the `indices` array has more than entries than can fit
     // in a single leaf index block. Therefore, we will need to split the entries
@@ -541,23 +715,24 @@ int BPlusTree::insertIntoLeaf(int relId, char attrName[ATTR_SIZE], int blockNum,
     // This function will return the blockNum of the newly allocated block or
     // E_DISKFULL if there are no more blocks to be allocated.
 
-    int newRightBlk = splitLeaf(blockNum, indices);
+    int newRightBlk = splitLeaf(blockNum, indices, numIndices);
 
     // if splitLeaf() returned E_DISKFULL
     //     return E_DISKFULL
     if(newRightBlk == E_DISKFULL)
         return E_DISKFULL;
 
+    // the last value of the left block (index 31, MIDDLE_INDEX_LEAF, for a full plain leaf)
+    int middle = (numIndices + 1) / 2 - 1;
+
     if (blockHeader.pblock != -1)
     {  // check pblock in header
         // insert the middle value from `indices` into the parent block using the
         // insertIntoInternal() function. (i.e the last value of the left block)
 
-        // the middle value will be at index 31 (given by constant MIDDLE_INDEX_LEAF)
-
-        // create a struct InternalEntry with attrVal = indices[MIDDLE_INDEX_LEAF].attrVal,
+        // create a struct InternalEntry with attrVal = indices[middle].attrVal,
         InternalEntry entry;
-        entry.attrVal = indices[MIDDLE_INDEX_LEAF].attrVal;
+        entry.attrVal = indices[middle].attrVal;
         // lChild = currentBlock, rChild = newRightBlk and pass it as argument to
         entry.lChild = blockNum;
         entry.rChild = newRightBlk;
@@ -573,16 +748,16 @@ int BPlusTree::insertIntoLeaf(int relId, char attrName[ATTR_SIZE], int blockNum,
     // block needs to be allocated and made the root of the tree.
     // To do this, call the createNewRoot() function with the following arguments
 
-    // createNewRoot(relId, attrName, indices[MIDDLE_INDEX_LEAF].attrVal,
+    // createNewRoot(relId, attrName, indices[middle].attrVal,
     //               current block, new right block)
-    return createNewRoot(relId,attrName,indices[MIDDLE_INDEX_LEAF].attrVal,blockNum,newRightBlk);
+    return createNewRoot(relId,attrName,indices[middle].attrVal,blockNum,newRightBlk);
 
 
     // if either of the above calls returned an error (E_DISKFULL), then return that
     // else return SUCCESS
 }
 
-int BPlusTree::splitLeaf(int leafBlockNum, Index indices[]) {
+int BPlusTree::splitLeaf(int leafBlockNum, Index indices[], int numIndices) {
     // declare rightBlk, an instance of IndLeaf using constructor 1 to obtain new
     // leaf index block that will be used as the right block in the splitting
 
@@ -599,42 +774,41 @@ int BPlusTree::splitLeaf(int leafBlockNum, Index indices[]) {
         return E_DISKFULL;
     }
 
+    // the left block keeps the first half, (MAX_KEYS_LEAF+1)/2 = 32 entries for
+    // a plain leaf (either half of a prefix leaf fits, see MAX_KEYS_LEAF_PREFIX)
+    int numLeft = (numIndices + 1) / 2;
+
     HeadInfo leftBlkHeader, rightBlkHeader;
     // get the headers of left block and right block using BlockBuffer::getHeader()
     left.getHeader(&leftBlkHeader);
     right.getHeader(&rightBlkHeader);
 
     // set rightBlkHeader with the following values
-    // - number of entries = (MAX_KEYS_LEAF+1)/2 = 32,
-    rightBlkHeader.numEntries = (MAX_KEYS_LEAF+1)/2;
+    // - number of entries = numIndices - numLeft,
+    rightBlkHeader.numEntries = numIndices - numLeft;
     // - pblock = pblock of leftBlk
     rightBlkHeader.pblock = leftBlkHeader.pblock;
     // - lblock = leftBlkNum
     rightBlkHeader.lblock = leftBlkNum;
     // - rblock = rblock of leftBlk
     rightBlkHeader.rblock = leftBlkHeader.rblock;
+    // - the same layout as leftBlk
+    rightBlkHeader.numSlots = leftBlkHeader.numSlots;
     // and update the header of rightBlk using BlockBuffer::setHeader()
     right.setHeader(&rightBlkHeader);
 
     // set leftBlkHeader with the following values
-    // - number of entries = (MAX_KEYS_LEAF+1)/2 = 32
-    leftBlkHeader.numEntries = (MAX_KEYS_LEAF+1)/2;
+    // - number of entries = numLeft
+    leftBlkHeader.numEntries = numLeft;
     // - rblock = rightBlkNum
     leftBlkHeader.rblock = rightBlkNum;
     // and update the header of leftBlk using BlockBuffer::setHeader() */
     left.setHeader(&leftBlkHeader);
 
-    // set the first 32 entries of leftBlk = the first 32 entries of indices array
-    for(int i=0;i<32;i++)
-    {
-        left.setEntry(&indices[i],i);
-    }
-    // and set the first 32 entries of newRightBlk = the next 32 entries of
-    // indices array using IndLeaf::setEntry().
-    for(int i=0;i<32;i++)
-    {
-        right.setEntry(&indices[i+32],i);
-    }
+    // set the entries of leftBlk = the first numLeft entries of indices array
+    // and the entries of newRightBlk = the rest, using IndLeaf::setEntries().
+    left.setEntries(indices, numLeft);
+    right.setEntries(indices + numLeft, numIndices - numLeft);
 
     return rightBlkNum;
 }
@@ -672,10 +846,15 @@ int BPlusTree::insertIntoInternal(int relId, char attrName[ATTR_SIZE], int intBl
         intBlk.getEntry(&indexentry,i);
         internalEntries[i] = indexentry;
     }
+    /* the new entry goes right before the entry whose lChild is the block that
+       was split (or at the end if it was the rChild of the last entry).
+       comparing keys is not enough: with duplicate keys several entries can
+       hold the same attrVal, and the first of them need not be the parent of
+       the split block */
     int j;
     for(j=0;j<blockHeader.numEntries;j++)
     {
-        if(compareAttrs(internalEntries[j].attrVal,intEntry.attrVal,attrCatEntry.attrType)>=0)
+        if(internalEntries[j].lChild == intEntry.lChild)
             break;
     }
     if(j==blockHeader.numEntries)
@@ -789,6 +968,8 @@ int BPlusTree::splitInternal(int intBlockNum, InternalEntry internalEntries[]) {
     // and update the header of rightBlk using BlockBuffer::setHeader()
     rightBlkHeader.numEntries = (MAX_KEYS_INTERNAL)/2;
     rightBlkHeader.pblock = leftBlkHeader.pblock;
+    // (the new block stores its entries the same way as the block being split)
+    rightBlkHeader.numSlots = leftBlkHeader.numSlots;
     rightBlk.setHeader(&rightBlkHeader);
 
     // set leftBlkHeader with the following values
@@ -866,6 +1047,8 @@ int BPlusTree::createNewRoot(int relId, char attrName[ATTR_SIZE], Attribute attr
     HeadInfo header;
     newRootBlk.getHeader(&header);
     header.numEntries = 1;
+    header.numAttrs = BPLUS_KEY_FORMAT;
+    header.numSlots = internalLayout(attrCatEntry.attrType);
     newRootBlk.setHeader(&header);
 
     // create a struct InternalEntry with lChild, attrVal and rChild from the
@@ -896,3 +1079,252 @@ int BPlusTree::createNewRoot(int relId, char attrName[ATTR_SIZE], Attribute attr
 
     return SUCCESS;
 }
+
+/*
+    Removes the entry {attrVal, recId} from the index on attrName of relation
+    relId. A block other than the root that is left less than about half full
+    is merged with a sibling if their entries fit in one block, and otherwise
+    takes entries from it; a root left with a single child is replaced by it.
+*/
+int BPlusTree::bPlusDelete(int relId, char attrName[ATTR_SIZE], Attribute attrVal, RecId recId) {
+    AttrCatEntry attrCatEntry;
+    int ret = AttrCacheTable::getAttrCatEntry(relId,attrName,&attrCatEntry);
+    if(ret!=SUCCESS)
+        return ret;
+
+    if (attrCatEntry.rootBlock == -1)
+        return E_NOINDEX;
+
+    int attrType = attrCatEntry.attrType;
+    normalizeKey(&attrVal, attrType);
+
+    // the leftmost leaf that can hold attrVal; entries with an equal key can
+    // continue into the leaves to its right
+    int block = findLeafToInsert(attrCatEntry.rootBlock, attrVal, attrType);
+    while (block != -1) {
+        IndLeaf leaf(block);
+        PageGuard guard(leaf);
+        HeadInfo leafHead;
+        leaf.getHeader(&leafHead);
+
+        for (int i = leaf.lowerBound(attrVal, attrType, false); i < leafHead.numEntries; i++) {
+            Index entry;
+            leaf.getEntry(&entry, i);
+            if (compareKeys(&entry.attrVal, &attrVal, attrType) != 0)
+                return E_NOTFOUND;
+            if (entry.block == recId.block && entry.slot == recId.slot)
+                return deleteFromLeaf(relId, attrName, block, i);
+        }
+        block = leafHead.rblock;
+    }
+
+    return E_NOTFOUND;
+}
+
+// keys and children of an internal block: key i lies between children i and i+1
+static void readInternal(IndInternal &block, std::vector<Attribute> &keys, std::vector<int> &children) {
+    HeadInfo header;
+    block.getHeader(&header);
+    keys.clear();
+    children.clear();
+    for (int i = 0; i < header.numEntries; i++) {
+        InternalEntry entry;
+        block.getEntry(&entry, i);
+        if (i == 0)
+            children.push_back(entry.lChild);
+        keys.push_back(entry.attrVal);
+        children.push_back(entry.rChild);
+    }
+}
+
+static void writeInternal(IndInternal &block, const std::vector<Attribute> &keys, const std::vector<int> &children) {
+    HeadInfo header;
+    block.getHeader(&header);
+    header.numEntries = keys.size();
+    block.setHeader(&header);
+    for (int i = 0; i < (int)keys.size(); i++) {
+        InternalEntry entry;
+        entry.lChild = children[i];
+        entry.attrVal = keys[i];
+        entry.rChild = children[i + 1];
+        block.setEntry(&entry, i);
+    }
+}
+
+static void setParent(int blockNum, int parentBlockNum) {
+    BlockBuffer block(blockNum);
+    HeadInfo header;
+    block.getHeader(&header);
+    header.pblock = parentBlockNum;
+    block.setHeader(&header);
+}
+
+// fewest entries a leaf other than the root keeps before it is rebalanced
+static int minLeafEntries(int layout) {
+    return layout == LEAF_LAYOUT_PREFIX ? MAX_KEYS_LEAF_PREFIX / 4 : MIDDLE_INDEX_LEAF + 1;
+}
+
+int BPlusTree::deleteFromLeaf(int relId, char attrName[ATTR_SIZE], int leafBlockNum, int indexNum) {
+    IndLeaf leaf(leafBlockNum);
+    HeadInfo leafHead;
+    leaf.getHeader(&leafHead);
+
+    std::vector<Index> entries(leafHead.numEntries);
+    for (int i = 0; i < leafHead.numEntries; i++)
+        leaf.getEntry(&entries[i], i);
+    entries.erase(entries.begin() + indexNum);
+    leaf.setEntries(entries.data(), entries.size());
+
+    // the root leaf can hold any number of entries
+    if (leafHead.pblock == -1 || (int)entries.size() >= minLeafEntries(leafHead.numSlots))
+        return SUCCESS;
+
+    // rebalance with the sibling to the left (to the right for the first child)
+    int parentBlockNum = leafHead.pblock;
+    IndInternal parent(parentBlockNum);
+    std::vector<Attribute> keys;
+    std::vector<int> children;
+    readInternal(parent, keys, children);
+    int pos = std::find(children.begin(), children.end(), leafBlockNum) - children.begin();
+    int sep = pos > 0 ? pos - 1 : 0;  // key between the two leaves in the parent
+
+    IndLeaf left(children[sep]), right(children[sep + 1]);
+    HeadInfo leftHead, rightHead;
+    left.getHeader(&leftHead);
+    right.getHeader(&rightHead);
+    std::vector<Index> all(leftHead.numEntries + rightHead.numEntries);
+    for (int i = 0; i < leftHead.numEntries; i++)
+        left.getEntry(&all[i], i);
+    for (int i = 0; i < rightHead.numEntries; i++)
+        right.getEntry(&all[leftHead.numEntries + i], i);
+    int total = all.size();
+
+    if (left.fits(all.data(), total)) {
+        // merge the right leaf into the left one and unlink it
+        left.setEntries(all.data(), total);
+        left.getHeader(&leftHead);
+        leftHead.rblock = rightHead.rblock;
+        left.setHeader(&leftHead);
+        if (rightHead.rblock != -1) {
+            IndLeaf next(rightHead.rblock);
+            HeadInfo nextHead;
+            next.getHeader(&nextHead);
+            nextHead.lblock = children[sep];
+            next.setHeader(&nextHead);
+        }
+        right.releaseBlock();
+
+        return deleteFromInternal(relId, attrName, parentBlockNum, sep);
+    }
+
+    // share the entries out again, splitting them as close to the middle as
+    // both leaves allow (the split they had before always fits)
+    int split = -1;
+    for (int d = 0; split == -1 && d <= total / 2; d++) {
+        for (int k : {total / 2 - d, total / 2 + d}) {
+            if (split == -1 && k > 0 && k < total && left.fits(all.data(), k)
+                && right.fits(all.data() + k, total - k))
+                split = k;
+        }
+    }
+    if (split == -1)
+        return SUCCESS;
+    left.setEntries(all.data(), split);
+    right.setEntries(all.data() + split, total - split);
+
+    // the separator is the largest key of the left leaf
+    InternalEntry entry;
+    parent.getEntry(&entry, sep);
+    entry.attrVal = all[split - 1].attrVal;
+    parent.setEntry(&entry, sep);
+
+    return SUCCESS;
+}
+
+/* removes key indexNum and the child to its right from an internal block */
+int BPlusTree::deleteFromInternal(int relId, char attrName[ATTR_SIZE], int intBlockNum, int indexNum) {
+    IndInternal node(intBlockNum);
+    HeadInfo header;
+    node.getHeader(&header);
+
+    std::vector<Attribute> keys;
+    std::vector<int> children;
+    readInternal(node, keys, children);
+    keys.erase(keys.begin() + indexNum);
+    children.erase(children.begin() + indexNum + 1);
+
+    if (header.pblock == -1 && keys.empty()) {
+        // the root is left with a single child, which becomes the root
+        int newRoot = children[0];
+        BlockBuffer rootBlk(newRoot);
+        HeadInfo rootHead;
+        rootBlk.getHeader(&rootHead);
+        rootHead.pblock = -1;
+        rootHead.numAttrs = BPLUS_KEY_FORMAT;
+        rootBlk.setHeader(&rootHead);
+        node.releaseBlock();
+
+        AttrCatEntry attrCatEntry;
+        AttrCacheTable::getAttrCatEntry(relId,attrName,&attrCatEntry);
+        attrCatEntry.rootBlock = newRoot;
+        AttrCacheTable::setAttrCatEntry(relId,attrName,&attrCatEntry);
+        return SUCCESS;
+    }
+
+    writeInternal(node, keys, children);
+    if (header.pblock == -1 || (int)keys.size() >= MIDDLE_INDEX_INTERNAL)
+        return SUCCESS;
+
+    // rebalance with the sibling to the left (to the right for the first child)
+    int parentBlockNum = header.pblock;
+    IndInternal parent(parentBlockNum);
+    std::vector<Attribute> parentKeys;
+    std::vector<int> parentChildren;
+    readInternal(parent, parentKeys, parentChildren);
+    int pos = std::find(parentChildren.begin(), parentChildren.end(), intBlockNum) - parentChildren.begin();
+    int sep = pos > 0 ? pos - 1 : 0;
+    int leftBlockNum = parentChildren[sep], rightBlockNum = parentChildren[sep + 1];
+
+    IndInternal left(leftBlockNum), right(rightBlockNum);
+    std::vector<Attribute> leftKeys, rightKeys;
+    std::vector<int> leftChildren, rightChildren;
+    readInternal(left, leftKeys, leftChildren);
+    readInternal(right, rightKeys, rightChildren);
+
+    // the keys of both blocks with the separator from the parent between them
+    std::vector<Attribute> allKeys(leftKeys);
+    allKeys.push_back(parentKeys[sep]);
+    allKeys.insert(allKeys.end(), rightKeys.begin(), rightKeys.end());
+    std::vector<int> allChildren(leftChildren);
+    allChildren.insert(allChildren.end(), rightChildren.begin(), rightChildren.end());
+
+    if ((int)allKeys.size() <= MAX_KEYS_INTERNAL) {
+        // merge the right block into the left one
+        writeInternal(left, allKeys, allChildren);
+        for (int child : rightChildren)
+            setParent(child, leftBlockNum);
+        right.releaseBlock();
+
+        return deleteFromInternal(relId, attrName, parentBlockNum, sep);
+    }
+
+    // share the keys out again; the middle one moves up to the parent
+    int middle = allKeys.size() / 2;
+    std::vector<Attribute> newLeftKeys(allKeys.begin(), allKeys.begin() + middle);
+    std::vector<int> newLeftChildren(allChildren.begin(), allChildren.begin() + middle + 1);
+    std::vector<Attribute> newRightKeys(allKeys.begin() + middle + 1, allKeys.end());
+    std::vector<int> newRightChildren(allChildren.begin() + middle + 1, allChildren.end());
+    writeInternal(left, newLeftKeys, newLeftChildren);
+    writeInternal(right, newRightKeys, newRightChildren);
+    for (int child : newLeftChildren)
+        setParent(child, leftBlockNum);
+    for (int child : newRightChildren)
+        setParent(child, rightBlockNum);
+
+    InternalEntry entry;
+    parent.getEntry(&entry, sep);
+    entry.attrVal = allKeys[middle];
+    parent.setEntry(&entry, sep);
+
+    return SUCCESS;
+}
@@ -11,16 +11,21 @@ class BPlusTree {
  private:
   static int findLeafToInsert(int rootBlock, Attribute attrVal, int attrType);
   static int insertIntoLeaf(int relId, char attrName[ATTR_SIZE], int blockNum, Index entry);
-  static int splitLeaf(int leafBlockNum, Index indices[]);
+  static int splitLeaf(int leafBlockNum, Index indices[], int numIndices);
   static int insertIntoInternal(int relId, char attrName[ATTR_SIZE], int intBlockNum, InternalEntry entry);
   static int splitInternal(int intBlockNum, InternalEntry internalEntries[]);
   static int createNewRoot(int relId, char attrName[ATTR_SIZE], Attribute attrVal, int lChild, int rChild);
+  static int bulkBuild(Index entries[], int numEntries, int attrType);
+  static int deleteFromLeaf(int relId, char attrName[ATTR_SIZE], int leafBlockNum, int indexNum);
+  static int deleteFromInternal(int relId, char attrName[ATTR_SIZE], int intBlockNum, int indexNum);
 
  public:
   static int bPlusCreate(int relId, char attrName[ATTR_SIZE]);
   static int bPlusInsert(int relId, char attrName[ATTR_SIZE], union Attribute attrVal, RecId recordId);
   static RecId bPlusSearch(int relId, char attrName[ATTR_SIZE], union Attribute attrVal, int op);
+  static int bPlusDelete(int relId, char attrName[ATTR_SIZE], union Attribute attrVal, RecId recId);
   static int bPlusDestroy(int rootBlockNum);
+  static int checkKeyFormat(int relId, char attrName[ATTR_SIZE]);
 };
 
 #endif  // NITCBASE_BPLUSTREE_H
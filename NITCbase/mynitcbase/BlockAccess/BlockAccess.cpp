@@ -1,6 +1,7 @@
 #include "BlockAccess.h"
 #include<cstdio>
 #include <cstring>
+#include <vector>
 
 RecId BlockAccess::linearSearch(int relId, char attrName[ATTR_SIZE], union Attribute attrVal, int op) {
     // get the previous search index of the relation relId from the relation cache
@@ -34,6 +35,14 @@ RecId BlockAccess::linearSearch(int relId, char attrName[ATTR_SIZE], union Attri
         slot = prevRecId.slot+ 1;
     }
 
+    /*
+        get the attribute offset and type for the attrName attribute
+        from the attribute cache entry of the relation using
+        AttrCacheTable::getAttrCatEntry() (once, not for every record)
+    */
+    AttrCatEntry attrCatEntry;
+    AttrCacheTable::getAttrCatEntry(relId,attrName,&attrCatEntry);
+
     /* The following code searches for the next record in the relation
        that satisfies the given condition
        We start from the record id (block, slot) and iterate over the remaining
@@ -42,85 +51,68 @@ RecId BlockAccess::linearSearch(int relId, char attrName[ATTR_SIZE], union Attri
     while (block != -1)
     {
         /* create a RecBuffer object for block (use RecBuffer Constructor for
-           existing block) */
+           existing block) and pin it, so that the header, the slot map and
+           all the records of the block are read from one buffer */
         RecBuffer currBlock(block);
-
-        // get the record with id (block, slot) using RecBuffer::getRecord()
+        PageGuard guard(currBlock);
 
         // get header of the block using RecBuffer::getHeader() function
         struct HeadInfo head;
         currBlock.getHeader(&head);
-        RelCatEntry relCatEntry;
-        RelCacheTable::getRelCatEntry(relId,&relCatEntry);
-        Attribute rec[head.numAttrs];
-        currBlock.getRecord(rec,slot);
-
 
         // get slot map of the block using RecBuffer::getSlotMap() function
         unsigned char slotMap[head.numSlots];
         currBlock.getSlotMap(slotMap);
-        // If slot >= the number of slots per block(i.e. no more slots in this block)
-        if(slot >= head.numSlots)
-        {
-            // update block = right block of block
-            block = head.rblock;
-            // update slot = 0
-            slot = 0;
-            continue;  // continue to the beginning of this while loop
-        }
+        Attribute rec[head.numAttrs];
 
-        // if slot is free skip the loop
-        // (i.e. check if slot'th entry in slot map of block contains SLOT_UNOCCUPIED)
-        if(slotMap[slot] == SLOT_UNOCCUPIED)
+        // check the remaining slots of the block
+        for (; slot < head.numSlots; slot++)
         {
-            slot++;
-            continue;
-            // increment slot and continue to the next record slot
-        }
-
-        // compare record's attribute value to the the given attrVal as below:
-        /*
-            firstly get the attribute offset for the attrName attribute
-            from the attribute cache entry of the relation using
-            AttrCacheTable::getAttrCatEntry()
-        */
-        /* use the attribute offset to get the value of the attribute from
-           current record */
-        AttrCatEntry attrCatEntry;
-        AttrCacheTable::getAttrCatEntry(relId,attrName,&attrCatEntry);
+            // if slot is free skip it
+            // (i.e. check if slot'th entry in slot map of block contains SLOT_UNOCCUPIED)
+            if(slotMap[slot] == SLOT_UNOCCUPIED)
+            {
+                continue;
+            }
 
-        int cmpVal;  // will store the difference between the attributes
-        // set cmpVal using compareAttrs()
-        cmpVal = compareAttrs(rec[attrCatEntry.offset],attrVal,attrCatEntry.attrType);
+            // get the record with id (block, slot) using RecBuffer::getRecord()
+            currBlock.getRecord(rec,slot);
 
+            int cmpVal;  // will store the difference between the attributes
+            // set cmpVal using compareAttrs()
+            cmpVal = compareAttrs(rec[attrCatEntry.offset],attrVal,attrCatEntry.attrType);
 
-        /* Next task is to check whether this record satisfies the given condition.
-           It is determined based on the output of previous comparison and
-           the op value received.
-           The following code sets the cond variable if the condition is satisfied.
-        */
-        if (
-            (op == NE && cmpVal != 0) ||    // if op is "not equal to"
-            (op == LT && cmpVal < 0) ||     // if op is "less than"
-            (op == LE && cmpVal <= 0) ||    // if op is "less than or equal to"
-            (op == EQ && cmpVal == 0) ||    // if op is "equal to"
-            (op == GT && cmpVal > 0) ||     // if op is "greater than"
-            (op == GE && cmpVal >= 0)       // if op is "greater than or equal to"
-        ) {
-            /*
-            set the search index in the relation cache as
-            the record id of the record that satisfies the given condition
-            (use RelCacheTable::setSearchIndex function)
+            /* Next task is to check whether this record satisfies the given condition.
+               It is determined based on the output of previous comparison and
+               the op value received.
+               The following code sets the cond variable if the condition is satisfied.
             */
-            RecId present;
-            present.block = block;
-            present.slot =slot;
-            RelCacheTable::setSearchIndex(relId,&present);
-
-            return {block,slot};
+            if (
+                (op == NE && cmpVal != 0) ||    // if op is "not equal to"
+                (op == LT && cmpVal < 0) ||     // if op is "less than"
+                (op == LE && cmpVal <= 0) ||    // if op is "less than or equal to"
+                (op == EQ && cmpVal == 0) ||    // if op is "equal to"
+                (op == GT && cmpVal > 0) ||     // if op is "greater than"
+                (op == GE && cmpVal >= 0)       // if op is "greater than or equal to"
+            ) {
+                /*
+                set the search index in the relation cache as
+                the record id of the record that satisfies the given condition
+                (use RelCacheTable::setSearchIndex function)
+                */
+                RecId present;
+                present.block = block;
+                present.slot =slot;
+                RelCacheTable::setSearchIndex(relId,&present);
+
+                return {block,slot};
+            }
         }
 
-        slot++;
+        // (no more slots in this block)
+        // update block = right block of block and slot = 0
+        block = head.rblock;
+        slot = 0;
     }
 
     // no record in the relation with Id relid satisfies the given condition
@@ -266,41 +258,195 @@ int BlockAccess::renameAttribute(char relName[ATTR_SIZE], char oldName[ATTR_SIZE
 }
 
 
+/*
+    Allocates a new record block for the relation and links it after the
+    current last block (or makes it the first block of an empty relation).
+    The free-space map and the relation cache entry (firstBlk, lastBlk) are
+    updated. Returns the new block number or E_DISKFULL / E_BUFFERFULL.
+*/
+int BlockAccess::appendRecordBlock(int relId) {
+    RelCatEntry relCatEntry;
+    RelCacheTable::getRelCatEntry(relId,&relCatEntry);
+
+    int prevBlockNum = relCatEntry.lastBlk;/* block number of the last element in the linked list */
+
+    // get a new record block (using the appropriate RecBuffer constructor!)
+    RecBuffer Buffer;
+    // get the block number of the newly allocated block
+    // (use BlockBuffer::getBlockNum() function)
+    int ret = Buffer.getBlockNum();
+
+    // let ret be the return value of getBlockNum() function call
+    if (ret == E_DISKFULL || ret == E_BUFFERFULL) {
+        return ret;
+    }
+    int blockNum = ret;
+
+    /*
+        set the header of the new record block such that it links with
+        existing record blocks of the relation
+        set the block's header as follows:
+        blockType: REC, pblock: -1
+        lblock
+              = -1 (if linked list of existing record blocks was empty
+                     i.e this is the first insertion into the relation)
+              = prevBlockNum (otherwise),
+        rblock: -1, numEntries: 0,
+        numSlots: numOfSlots, numAttrs: numOfAttributes
+        (use BlockBuffer::setHeader() function)
+    */
+    struct HeadInfo header;
+    header.blockType = REC;
+    header.pblock = -1;
+    header.rblock = -1;
+    header.numEntries = 0;
+    header.numAttrs = relCatEntry.numAttrs;
+    header.numSlots = relCatEntry.numSlotsPerBlk;
+    if(relCatEntry.firstBlk == -1)
+        header.lblock=-1;
+    else
+        header.lblock = prevBlockNum;
+    RecBuffer recBuffer(blockNum);
+    recBuffer.setHeader(&header);
+
+    /*
+        set block's slot map with all slots marked as free
+        (i.e. store SLOT_UNOCCUPIED for all the entries)
+        (use RecBuffer::setSlotMap() function)
+    */
+    unsigned char slotMap[relCatEntry.numSlotsPerBlk];
+    for(int i=0;i<relCatEntry.numSlotsPerBlk;i++)
+        slotMap[i] = SLOT_UNOCCUPIED;
+    recBuffer.setSlotMap(slotMap);
+
+    // if prevBlockNum != -1
+    if(prevBlockNum != -1)
+    {
+        // create a RecBuffer object for prevBlockNum
+        RecBuffer buf(prevBlockNum);
+        // get the header of the block prevBlockNum and
+        struct HeadInfo bufhead;
+        buf.getHeader(&bufhead);
+        // update the rblock field of the header to the new block
+        // number i.e. blockNum
+        bufhead.rblock = blockNum;
+        // (use BlockBuffer::setHeader() function)
+        buf.setHeader(&bufhead);
+    }
+    else
+    {
+        // update first block field in the relation catalog entry to the
+        // new block
+        relCatEntry.firstBlk = blockNum;
+    }
+
+    // update last block field in the relation catalog entry to the
+    // new block (using RelCacheTable::setRelCatEntry() function)
+    relCatEntry.lastBlk = blockNum;
+    relCatEntry.numBlks += 1;
+    RelCacheTable::setRelCatEntry(relId,&relCatEntry);
+    RelCacheTable::setFreeSpace(relId,blockNum,true);
+
+    return blockNum;
+}
+
+/*
+    Inserts numRecords records into the relation, filling each record block
+    with as many records as fit before touching the slot map and header once
+    per block. B+ tree indexes of the relation are NOT updated; the rec-id of
+    every inserted record is stored in recIds so that the caller can index
+    them. *numInserted is set to the number of records inserted, which is less
+    than numRecords only if an error is returned.
+*/
+int BlockAccess::bulkInsert(int relId, Attribute *records, int numRecords, RecId *recIds, int *numInserted) {
+    *numInserted = 0;
+    if(relId == RELCAT_RELID || relId == ATTRCAT_RELID)
+        return E_NOTPERMITTED;
+
+    RelCatEntry relCatEntry;
+    int ret = RelCacheTable::getRelCatEntry(relId,&relCatEntry);
+    if(ret != SUCCESS)
+        return ret;
+
+    int numOfSlots = relCatEntry.numSlotsPerBlk;
+    int numOfAttributes = relCatEntry.numAttrs;
+
+    int inserted = 0;
+    ret = SUCCESS;
+    while(inserted < numRecords)
+    {
+        int blockNum = RelCacheTable::getBlockWithFreeSlot(relId);
+        if(blockNum < 0)
+        {
+            blockNum = appendRecordBlock(relId);
+            if(blockNum < 0)
+            {
+                ret = blockNum;
+                break;
+            }
+        }
+
+        // keep the block pinned while it is filled
+        RecBuffer buffer(blockNum);
+        PageGuard guard(buffer);
+
+        unsigned char slotMap[numOfSlots];
+        buffer.getSlotMap(slotMap);
+        HeadInfo header;
+        buffer.getHeader(&header);
+
+        for(int slot=0;slot<numOfSlots && inserted<numRecords;slot++)
+        {
+            if(slotMap[slot] == SLOT_OCCUPIED)
+                continue;
+            buffer.setRecord(records + (long)inserted*numOfAttributes, slot);
+            slotMap[slot] = SLOT_OCCUPIED;
+            recIds[inserted].block = blockNum;
+            recIds[inserted].slot = slot;
+            header.numEntries++;
+            inserted++;
+        }
+
+        buffer.setSlotMap(slotMap);
+        buffer.setHeader(&header);
+        // full (or the map was stale): no free slot left in this block
+        if(header.numEntries >= numOfSlots)
+            RelCacheTable::setFreeSpace(relId,blockNum,false);
+    }
+
+    // appendRecordBlock() may have changed firstBlk/lastBlk
+    RelCacheTable::getRelCatEntry(relId,&relCatEntry);
+    relCatEntry.numRecs += inserted;
+    RelCacheTable::setRelCatEntry(relId,&relCatEntry);
+
+    *numInserted = inserted;
+    return ret;
+}
+
 int BlockAccess::insert(int relId, Attribute *record) {
     // get the relation catalog entry from relation cache
     // ( use RelCacheTable::getRelCatEntry() of Cache Layer)
     RelCatEntry relCatEntry;
     RelCacheTable::getRelCatEntry(relId,&relCatEntry);
 
-    int blockNum = relCatEntry.firstBlk; /* first record block of the relation (from the rel-cat entry)*/
-
     // rec_id will be used to store where the new record will be inserted
     RecId rec_id = {-1, -1};
 
     int numOfSlots = relCatEntry.numSlotsPerBlk;/* number of slots per record block */
-    int numOfAttributes = relCatEntry.numAttrs;/* number of attributes of the relation */
-
-    int prevBlockNum = -1;/* block number of the last element in the linked list = -1 */
 
     /*
-        Traversing the linked list of existing record blocks of the relation
-        until a free slot is found OR
-        until the end of the list is reached
+        Instead of walking the linked list of record blocks, ask the free-space
+        map of the relation cache for a block with a free slot (the last block
+        is tried first). If there is none, a new block is appended after lastBlk.
     */
-    while (blockNum != -1) {
-        // create a RecBuffer object for blockNum (using appropriate constructor!)
+    int blockNum;
+    while ((blockNum = RelCacheTable::getBlockWithFreeSlot(relId)) >= 0) {
         RecBuffer buffer(blockNum);
-        // get header of block(blockNum) using RecBuffer::getHeader() function
-        struct HeadInfo header;
-        buffer.getHeader(&header);
-        // get slot map of block(blockNum) using RecBuffer::getSlotMap() function
-        unsigned char slotMap[numOfSlots];
-        buffer.getSlotMap(slotMap);
         // search for free slot in the block 'blockNum' and store it's rec-id in rec_id
         // (Free slot can be found by iterating over the slot map of the block)
-
-        int i;
-        for(i=0;i<numOfSlots;i++)
+        unsigned char slotMap[numOfSlots];
+        buffer.getSlotMap(slotMap);
+        for(int i=0;i<numOfSlots;i++)
         {
             if(slotMap[i] == SLOT_UNOCCUPIED)
             {
@@ -309,24 +455,10 @@ int BlockAccess::insert(int relId, Attribute *record) {
                 break;
             }
         }
-        if(i != numOfSlots)
-        {
+        if(rec_id.block != -1)
             break;
-        }
-        /* slot map stores SLOT_UNOCCUPIED if slot is free and
-           SLOT_OCCUPIED if slot is occupied) */
-
-        /* if a free slot is found, set rec_id and discontinue the traversal
-           of the linked list of record blocks (break from the loop) */
-
-        /* otherwise, continue to check the next block by updating the
-           block numbers as follows:
-              update prevBlockNum = blockNum
-              update blockNum = header.rblock (next element in the linked
-                                               list of record blocks)
-        */
-        prevBlockNum = blockNum;
-        blockNum = header.rblock;
+        // the map was stale, the block is full
+        RelCacheTable::setFreeSpace(relId,blockNum,false);
     }
 
     //  if no free slot is found in existing record blocks (rec_id = {-1, -1})
@@ -337,84 +469,18 @@ int BlockAccess::insert(int relId, Attribute *record) {
         if(relId == RELCAT_RELID)
             return E_MAXRELATIONS;
 
-        // Otherwise,
-        // get a new record block (using the appropriate RecBuffer constructor!)
-        RecBuffer Buffer;
-        // get the block number of the newly allocated block
-        // (use BlockBuffer::getBlockNum() function)
-        int ret = Buffer.getBlockNum();
-
-        // let ret be the return value of getBlockNum() function call
-        if (ret == E_DISKFULL) {
-            return E_DISKFULL;
+        // Otherwise, link a new record block after the last block
+        int ret = appendRecordBlock(relId);
+        if (ret < 0) {
+            return ret;
         }
 
         // Assign rec_id.block = new block number(i.e. ret) and rec_id.slot = 0
         rec_id.block = ret;
         rec_id.slot =0;
-        /*
-            set the header of the new record block such that it links with
-            existing record blocks of the relation
-            set the block's header as follows:
-            blockType: REC, pblock: -1
-            lblock
-                  = -1 (if linked list of existing record blocks was empty
-                         i.e this is the first insertion into the relation)
-                  = prevBlockNum (otherwise),
-            rblock: -1, numEntries: 0,
-            numSlots: numOfSlots, numAttrs: numOfAttributes
-            (use BlockBuffer::setHeader() function)
-        */
-        struct HeadInfo header;
-        header.blockType = REC;
-        header.pblock = -1;
-        header.rblock = -1;
-        header.numEntries = 0;
-        header.numAttrs = numOfAttributes;
-        header.numSlots = numOfSlots;
-        if(relCatEntry.firstBlk == -1)
-            header.lblock=-1;
-        else
-            header.lblock = prevBlockNum;
-        RecBuffer recBuffer(rec_id.block);
-        recBuffer.setHeader(&header);
-
-        /*
-            set block's slot map with all slots marked as free
-            (i.e. store SLOT_UNOCCUPIED for all the entries)
-            (use RecBuffer::setSlotMap() function)
-        */
-        unsigned char slotMap[numOfSlots];
-        for(int i=0;i<numOfSlots;i++)
-            slotMap[i] = SLOT_UNOCCUPIED;
-        recBuffer.setSlotMap(slotMap);
-
-        // if prevBlockNum != -1
-        if(prevBlockNum != -1)
-        {
-            // create a RecBuffer object for prevBlockNum
-            RecBuffer buf(prevBlockNum);
-            // get the header of the block prevBlockNum and
-            struct HeadInfo bufhead;
-            buf.getHeader(&bufhead);
-            // update the rblock field of the header to the new block
-            // number i.e. rec_id.block
-            bufhead.rblock = rec_id.block;
-            // (use BlockBuffer::setHeader() function)
-            buf.setHeader(&bufhead);
-        }
-        else
-        {
-            // update first block field in the relation catalog entry to the
-            // new block (using RelCacheTable::setRelCatEntry() function)
-            relCatEntry.firstBlk = rec_id.block;
-            RelCacheTable::setRelCatEntry(relId,&relCatEntry);
-        }
 
-        // update last block field in the relation catalog entry to the
-        // new block (using RelCacheTable::setRelCatEntry() function)
-        relCatEntry.lastBlk = rec_id.block;
-        RelCacheTable::setRelCatEntry(relId,&relCatEntry);
+        // appendRecordBlock() updated firstBlk/lastBlk in the relation cache
+        RelCacheTable::getRelCatEntry(relId,&relCatEntry);
     }
 
     // create a RecBuffer object for rec_id.block
@@ -438,6 +504,8 @@ int BlockAccess::insert(int relId, Attribute *record) {
     newrec.getHeader(&newhead);
     newhead.numEntries+=1;
     newrec.setHeader(&newhead);
+    if(newhead.numEntries == newhead.numSlots)
+        RelCacheTable::setFreeSpace(relId,rec_id.block,false);
 
     // Increment the number of records field in the relation cache entry for
     // the relation. (use RelCacheTable::setRelCatEntry function)
@@ -537,6 +605,230 @@ int BlockAccess::search(int relId, Attribute *record, char attrName[ATTR_SIZE],
     return SUCCESS;
 }
 
+/*
+Deletes the record recId of the relation relId: its entries are removed from the
+indexes of the relation, its slot is freed and, if that leaves the record block
+empty, the block is unlinked from the relation and released.
+*/
+int BlockAccess::deleteRecord(int relId, RecId recId) {
+    // the catalogs are only changed through the schema layer
+    if(relId == RELCAT_RELID || relId == ATTRCAT_RELID)
+        return E_NOTPERMITTED;
+
+    RelCatEntry relCatEntry;
+    RelCacheTable::getRelCatEntry(relId,&relCatEntry);
+
+    RecBuffer buffer(recId.block);
+    PageGuard guard(buffer);
+    HeadInfo header;
+    buffer.getHeader(&header);
+
+    unsigned char slotMap[header.numSlots];
+    buffer.getSlotMap(slotMap);
+    if(recId.slot < 0 || recId.slot >= header.numSlots || slotMap[recId.slot] == SLOT_UNOCCUPIED)
+        return E_FREESLOT;
+
+    Attribute record[relCatEntry.numAttrs];
+    buffer.getRecord(record,recId.slot);
+
+    /* B+ Tree Deletions */
+    for(int attrOffset=0;attrOffset<relCatEntry.numAttrs;attrOffset++)
+    {
+        AttrCatEntry attrCatEntry;
+        AttrCacheTable::getAttrCatEntry(relId, attrOffset, &attrCatEntry);
+        if(attrCatEntry.rootBlock != -1)
+            BPlusTree::bPlusDelete(relId, attrCatEntry.attrName, record[attrOffset], recId);
+    }
+
+    // free the slot and decrement numEntries of the block
+    slotMap[recId.slot] = SLOT_UNOCCUPIED;
+    buffer.setSlotMap(slotMap);
+    header.numEntries-=1;
+    buffer.setHeader(&header);
+    relCatEntry.numRecs-=1;
+
+    if(header.numEntries > 0)
+    {
+        RelCacheTable::setFreeSpace(relId,recId.block,true);
+        RelCacheTable::setRelCatEntry(relId,&relCatEntry);
+        return SUCCESS;
+    }
+
+    /* the block is empty: unlink it from the linked list of record blocks of
+       the relation (fixing firstBlk / lastBlk if it was at either end) */
+    if(header.lblock != -1)
+    {
+        RecBuffer leftBlock(header.lblock);
+        HeadInfo leftHeader;
+        leftBlock.getHeader(&leftHeader);
+        leftHeader.rblock = header.rblock;
+        leftBlock.setHeader(&leftHeader);
+    }
+    else
+        relCatEntry.firstBlk = header.rblock;
+
+    if(header.rblock != -1)
+    {
+        RecBuffer rightBlock(header.rblock);
+        HeadInfo rightHeader;
+        rightBlock.getHeader(&rightHeader);
+        rightHeader.lblock = header.lblock;
+        rightBlock.setHeader(&rightHeader);
+    }
+    else
+        relCatEntry.lastBlk = header.lblock;
+
+    buffer.releaseBlock();
+    RelCacheTable::setFreeSpace(relId,recId.block,false);
+    relCatEntry.numBlks-=1;
+    RelCacheTable::setRelCatEntry(relId,&relCatEntry);
+
+    return SUCCESS;
+}
+
+/*
+Deletes every record of the relation relId whose attribute attrName satisfies
+`op attrVal` and sets *numDeleted to the number of records deleted. The records
+are found first (through the index on attrName if there is one) and deleted
+afterwards, so that the deletions do not disturb the search.
+*/
+int BlockAccess::deleteRecords(int relId, char attrName[ATTR_SIZE], Attribute attrVal, int op, int *numDeleted) {
+    *numDeleted = 0;
+
+    AttrCatEntry attrCatEntry;
+    int ret = AttrCacheTable::getAttrCatEntry(relId, attrName, &attrCatEntry);
+    if(ret != SUCCESS)
+        return ret;
+
+    RelCacheTable::resetSearchIndex(relId);
+    AttrCacheTable::resetSearchIndex(relId, attrName);
+
+    std::vector<RecId> recIds;
+    while(true)
+    {
+        RecId recId;
+        if(attrCatEntry.rootBlock == -1)
+            recId = linearSearch(relId, attrName, attrVal, op);
+        else
+            recId = BPlusTree::bPlusSearch(relId, attrName, attrVal, op);
+        if(recId.block == -1 && recId.slot == -1)
+            break;
+        recIds.push_back(recId);
+    }
+
+    for(RecId recId : recIds)
+    {
+        ret = deleteRecord(relId, recId);
+        if(ret != SUCCESS)
+            return ret;
+        (*numDeleted)++;
+    }
+
+    return SUCCESS;
+}
+
+/*
+Sets the attribute at attrOffset of the record recId to newVal, in place. Only
+the index on that attribute (if there is one) is changed: the entry with the
+old value is removed and one with the new value is inserted.
+*/
+int BlockAccess::updateRecord(int relId, RecId recId, int attrOffset, Attribute newVal) {
+    // the catalogs are only changed through the schema layer
+    if(relId == RELCAT_RELID || relId == ATTRCAT_RELID)
+        return E_NOTPERMITTED;
+
+    RelCatEntry relCatEntry;
+    RelCacheTable::getRelCatEntry(relId,&relCatEntry);
+    if(attrOffset < 0 || attrOffset >= relCatEntry.numAttrs)
+        return E_ATTRNOTEXIST;
+
+    RecBuffer buffer(recId.block);
+    PageGuard guard(buffer);
+    HeadInfo header;
+    buffer.getHeader(&header);
+
+    unsigned char slotMap[header.numSlots];
+    buffer.getSlotMap(slotMap);
+    if(recId.slot < 0 || recId.slot >= header.numSlots || slotMap[recId.slot] == SLOT_UNOCCUPIED)
+        return E_FREESLOT;
+
+    AttrCatEntry attrCatEntry;
+    AttrCacheTable::getAttrCatEntry(relId, attrOffset, &attrCatEntry);
+
+    Attribute record[relCatEntry.numAttrs];
+    buffer.getRecord(record,recId.slot);
+
+    // nothing to write if the value does not change
+    if(compareAttrs(record[attrOffset], newVal, attrCatEntry.attrType) == 0)
+        return SUCCESS;
+
+    if(attrCatEntry.rootBlock != -1)
+        BPlusTree::bPlusDelete(relId, attrCatEntry.attrName, record[attrOffset], recId);
+
+    record[attrOffset] = newVal;
+    buffer.setRecord(record,recId.slot);
+
+    if(attrCatEntry.rootBlock != -1)
+    {
+        int retVal = BPlusTree::bPlusInsert(relId, attrCatEntry.attrName, newVal, recId);
+        if(retVal == E_DISKFULL)
+            return E_INDEX_BLOCKS_RELEASED;
+    }
+
+    return SUCCESS;
+}
+
+/*
+Sets the attribute setAttrName to newVal in every record of the relation relId
+whose attribute attrName satisfies `op attrVal`, and sets *numUpdated to the
+number of records changed. As in deleteRecords(), all the records are found
+before any of them is changed, so that a record whose new value still satisfies
+the condition is not found (and updated) again.
+*/
+int BlockAccess::updateRecords(int relId, char setAttrName[ATTR_SIZE], Attribute newVal,
+                               char attrName[ATTR_SIZE], Attribute attrVal, int op, int *numUpdated) {
+    *numUpdated = 0;
+
+    AttrCatEntry setAttrCatEntry;
+    int ret = AttrCacheTable::getAttrCatEntry(relId, setAttrName, &setAttrCatEntry);
+    if(ret != SUCCESS)
+        return ret;
+
+    AttrCatEntry attrCatEntry;
+    ret = AttrCacheTable::getAttrCatEntry(relId, attrName, &attrCatEntry);
+    if(ret != SUCCESS)
+        return ret;
+
+    RelCacheTable::resetSearchIndex(relId);
+    AttrCacheTable::resetSearchIndex(relId, attrName);
+
+    std::vector<RecId> recIds;
+    while(true)
+    {
+        RecId recId;
+        if(attrCatEntry.rootBlock == -1)
+            recId = linearSearch(relId, attrName, attrVal, op);
+        else
+            recId = BPlusTree::bPlusSearch(relId, attrName, attrVal, op);
+        if(recId.block == -1 && recId.slot == -1)
+            break;
+        recIds.push_back(recId);
+    }
+
+    int flag = SUCCESS;
+    for(RecId recId : recIds)
+    {
+        ret = updateRecord(relId, recId, setAttrCatEntry.offset, newVal);
+        if(ret == E_INDEX_BLOCKS_RELEASED)
+            flag = ret;
+        else if(ret != SUCCESS)
+            return ret;
+        (*numUpdated)++;
+    }
+
+    return flag;
+}
+
 int BlockAccess::deleteRelation(char relName[ATTR_SIZE]) {
     // if the relation to delete is either Relation Catalog or Attribute Catalog,
     //     return E_NOTPERMITTED
@@ -638,6 +930,7 @@ int BlockAccess::deleteRelation(char relName[ATTR_SIZE]) {
            using RecBuffer.setHeader */
         attrCatHeader.numEntries-=1;
         attrCatBuffer.setHeader(&attrCatHeader);
+        RelCacheTable::setFreeSpace(ATTRCAT_RELID,attrCatRecId.block,true);
         /* If number of entries become 0, releaseBlock is called after fixing
            the linked list.
         */
@@ -683,6 +976,11 @@ int BlockAccess::deleteRelation(char relName[ATTR_SIZE]) {
             //  every block of the attribute catalog gets released.)
             attrCatBuffer.releaseBlock();
             // call releaseBlock()
+            RelCacheTable::setFreeSpace(ATTRCAT_RELID,attrCatRecId.block,false);
+            RelCatEntry attrCatEntry;
+            RelCacheTable::getRelCatEntry(ATTRCAT_RELID,&attrCatEntry);
+            attrCatEntry.numBlks -= 1;
+            RelCacheTable::setRelCatEntry(ATTRCAT_RELID,&attrCatEntry);
         }
 
         // (the following part is only relevant once indexing has been implemented)
@@ -708,6 +1006,7 @@ int BlockAccess::deleteRelation(char relName[ATTR_SIZE]) {
     buffer.getSlotMap(slotmap);
     slotmap[recId.slot] = SLOT_UNOCCUPIED;
     buffer.setSlotMap(slotmap);
+    RelCacheTable::setFreeSpace(RELCAT_RELID,RELCAT_BLOCK,true);
     /*** Updating the Relation Cache Table ***/
     /** Update relation catalog record entry (number of records in relation
         catalog is decreased by 1) **/
@@ -782,7 +1081,9 @@ int BlockAccess::project(int relId, Attribute *record) {
     while (block != -1)
     {
         // create a RecBuffer object for block (using appropriate constructor!)
+        // and pin it while its slots are checked
         RecBuffer buffer(block);
+        PageGuard guard(buffer);
         // get header of the block using RecBuffer::getHeader() function
         HeadInfo header;
         buffer.getHeader(&header);
@@ -790,6 +1091,12 @@ int BlockAccess::project(int relId, Attribute *record) {
         unsigned char slotMap[header.numSlots];
         buffer.getSlotMap(slotMap);
 
+        // skip the unoccupied slots of the block
+        while (slot < header.numSlots && slotMap[slot] == SLOT_UNOCCUPIED)
+        {
+            slot++;
+        }
+
         if(slot >= header.numSlots)
         {
             // (no more slots in this block)
@@ -799,37 +1106,25 @@ int BlockAccess::project(int relId, Attribute *record) {
             slot = 0;
             // (NOTE: if this is the last block, rblock would be -1. this would
             //        set block = -1 and fail the loop condition )
+            continue;
         }
-        else if (slotMap[slot] == SLOT_UNOCCUPIED)
-        {
-            // (i.e slot-th entry in slotMap contains SLOT_UNOCCUPIED)
-            slot++;
-            // increment slot
-        }
-        else {
-            // (the next occupied slot / record has been found)
-            break;
-        }
-    }
 
-    if (block == -1){
-        // (a record was not found. all records exhausted)
-        return E_NOTFOUND;
-    }
+        // (the next occupied slot / record has been found)
 
-    // declare nextRecId to store the RecId of the record found
-    RecId nextRecId = {block, slot};
+        // declare nextRecId to store the RecId of the record found
+        RecId nextRecId = {block, slot};
 
-    // set the search index to nextRecId using RelCacheTable::setSearchIndex
-    RelCacheTable::setSearchIndex(relId,&nextRecId);
+        // set the search index to nextRecId using RelCacheTable::setSearchIndex
+        RelCacheTable::setSearchIndex(relId,&nextRecId);
 
-    /* Copy the record with record id (nextRecId) to the record buffer (record)
-       For this Instantiate a RecBuffer class object by passing the recId and
-       call the appropriate method to fetch the record
-    */
-    RecBuffer buf(block);
-    buf.getRecord(record, slot);
+        // copy the record with record id (nextRecId) to the record buffer (record)
+        // from the block that is still pinned
+        buffer.getRecord(record, slot);
 
-    return SUCCESS;
+        return SUCCESS;
+    }
+
+    // (a record was not found. all records exhausted)
+    return E_NOTFOUND;
 }
 
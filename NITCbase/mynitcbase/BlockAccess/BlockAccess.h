@@ -14,6 +14,17 @@ class BlockAccess {
 
   static int insert(int relId, union Attribute *record);
 
+  static int bulkInsert(int relId, union Attribute *records, int numRecords, RecId *recIds, int *numInserted);
+
+  static int deleteRecord(int relId, RecId recId);
+
+  static int deleteRecords(int relId, char *attrName, Attribute attrVal, int op, int *numDeleted);
+
+  static int updateRecord(int relId, RecId recId, int attrOffset, Attribute newVal);
+
+  static int updateRecords(int relId, char *setAttrName, Attribute newVal, char *attrName, Attribute attrVal,
+                           int op, int *numUpdated);
+
   static int renameRelation(char *oldName, char *newName);
 
   static int renameAttribute(char *relName, char *oldName, char *newName);
@@ -23,6 +34,9 @@ class BlockAccess {
   static RecId linearSearch(int relId, char *attrName, Attribute attrVal, int op);
 
   static int project(int relId, Attribute *record);
+
+ private:
+  static int appendRecordBlock(int relId);
 };
 
 #endif  // NITCBASE_BLOCKACCESS_H
\ No newline at end of file
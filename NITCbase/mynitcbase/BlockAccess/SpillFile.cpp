@@ -0,0 +1,103 @@
+#include "SpillFile.h"
+
+SpillFile::SpillFile(int numAttrs) {
+  this->numAttrs = numAttrs;
+  // same number of slots as a record block of a relation with numAttrs attributes
+  this->numSlots = (BLOCK_SIZE - HEADER_SIZE) / (numAttrs * ATTR_SIZE + 1);
+  this->firstBlk = -1;
+  this->lastBlk = -1;
+  this->numRecords = 0;
+  this->readBlock = -1;
+  this->readSlot = 0;
+}
+
+/* adds record at the end of the file. Returns E_DISKFULL if a new block is needed
+   and there is none left */
+int SpillFile::append(union Attribute *record) {
+  HeadInfo header;
+  if (lastBlk != -1) {
+    RecBuffer block(lastBlk);
+    block.getHeader(&header);
+    if (header.numEntries < numSlots) {
+      block.setRecord(record, header.numEntries);
+      header.numEntries++;
+      block.setHeader(&header);
+      numRecords++;
+      return SUCCESS;
+    }
+  }
+
+  // the last block is full (or there is none yet)
+  RecBuffer newBlock;
+  int blockNum = newBlock.getBlockNum();
+  if (blockNum == E_DISKFULL || blockNum == E_BUFFERFULL)
+    return blockNum;
+
+  header.blockType = REC;
+  header.pblock = -1;
+  header.lblock = lastBlk;
+  header.rblock = -1;
+  header.numEntries = 1;
+  header.numAttrs = numAttrs;
+  header.numSlots = numSlots;
+  newBlock.setHeader(&header);
+  // the slot map is not used; records fill the slots of a block in order
+  newBlock.setRecord(record, 0);
+
+  if (lastBlk != -1) {
+    RecBuffer prevBlock(lastBlk);
+    HeadInfo prevHeader;
+    prevBlock.getHeader(&prevHeader);
+    prevHeader.rblock = blockNum;
+    prevBlock.setHeader(&prevHeader);
+  } else {
+    firstBlk = blockNum;
+  }
+  lastBlk = blockNum;
+  numRecords++;
+
+  return SUCCESS;
+}
+
+/* makes the next read() return the first record of the file */
+void SpillFile::rewind() {
+  readBlock = firstBlk;
+  readSlot = 0;
+}
+
+/* copies the next record into *record. Returns E_NOTFOUND after the last record */
+int SpillFile::read(union Attribute *record) {
+  while (readBlock != -1) {
+    RecBuffer block(readBlock);
+    HeadInfo header;
+    block.getHeader(&header);
+    if (readSlot < header.numEntries) {
+      block.getRecord(record, readSlot);
+      readSlot++;
+      return SUCCESS;
+    }
+    readBlock = header.rblock;
+    readSlot = 0;
+  }
+  return E_NOTFOUND;
+}
+
+int SpillFile::getNumRecords() {
+  return numRecords;
+}
+
+/* gives the blocks of the file back to the disk; the file is empty afterwards */
+void SpillFile::release() {
+  int block = firstBlk;
+  while (block != -1) {
+    RecBuffer recBuffer(block);
+    HeadInfo header;
+    recBuffer.getHeader(&header);
+    recBuffer.releaseBlock();
+    block = header.rblock;
+  }
+  firstBlk = lastBlk = -1;
+  numRecords = 0;
+  readBlock = -1;
+  readSlot = 0;
+}
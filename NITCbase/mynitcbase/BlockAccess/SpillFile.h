@@ -0,0 +1,34 @@
+#ifndef NITCBASE_SPILLFILE_H
+#define NITCBASE_SPILLFILE_H
+
+#include "../Buffer/BlockBuffer.h"
+#include "../define/constants.h"
+
+/*
+A temporary sequence of records written to disk by an operator that does not
+have enough memory for its input (join partitions, sort runs, ...). The records
+are kept in a linked list of record blocks that belong to no relation, so the
+catalogs are not touched; the blocks go through StaticBuffer like any other
+block. The owner must call release() once the records are no longer needed.
+*/
+class SpillFile {
+ private:
+  int numAttrs;
+  int numSlots;
+  int firstBlk;
+  int lastBlk;
+  int numRecords;
+  // next record returned by read()
+  int readBlock;
+  int readSlot;
+
+ public:
+  SpillFile(int numAttrs);
+  int append(union Attribute *record);
+  void rewind();
+  int read(union Attribute *record);
+  int getNumRecords();
+  void release();
+};
+
+#endif  // NITCBASE_SPILLFILE_H
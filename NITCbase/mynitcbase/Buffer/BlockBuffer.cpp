@@ -3,9 +3,15 @@
 #include <cstdlib>
 #include <cstring>
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
 BlockBuffer::BlockBuffer(int blockNum)
 {
   this->blockNum=blockNum;// initialise this.blockNum with the argument
+  this->pinnedBuffer = -1;
+  this->pinDepth = 0;
 }
 
 BlockBuffer::BlockBuffer(char blockType){
@@ -19,6 +25,8 @@ BlockBuffer::BlockBuffer(char blockType){
   else if(blockType == 'L')
     x=IND_LEAF;
 
+  this->pinnedBuffer = -1;
+  this->pinDepth = 0;
   int temp = getFreeBlock(x);
     // set the blockNum field of the object to that of the allocated block
     // number if the method returned a valid block number,
@@ -87,13 +95,11 @@ int RecBuffer::getRecord(union Attribute *rec, int slotNum)
     return ret;
   }
 
-  struct HeadInfo head;
-
-  // get the header using this.getHeader() function
-  this->getHeader(&head);
+  // the header is read straight from the buffer loaded above
+  struct HeadInfo *head = (struct HeadInfo *)bufferPtr;
 
-  int attrCount = head.numAttrs;
-  int slotCount = head.numSlots;
+  int attrCount = head->numAttrs;
+  int slotCount = head->numSlots;
 
   // read the block at this.blockNum into a buffer
   // unsigned char buffer[BLOCK_SIZE];
@@ -113,38 +119,22 @@ int RecBuffer::getRecord(union Attribute *rec, int slotNum)
 }
 
 int BlockBuffer::loadBlockAndGetBufferPtr(unsigned char **buffPtr) {
-  // check whether the block is already present in the buffer using StaticBuffer.getBufferNum()
-  int bufferNum = StaticBuffer::getBufferNum(this->blockNum);
-
-  // if present (!=E_BLOCKNOTINBUFFER),
-        // set the timestamp of the corresponding buffer to 0 and increment the
-        // timestamps of all other occupied buffers in BufferMetaInfo.
-  if(bufferNum != E_BLOCKNOTINBUFFER)
-  {
-    StaticBuffer::metainfo[bufferNum].timeStamp = 0;
-    for(int i=0; i< BUFFER_CAPACITY; i++)
-    {
-      if(i!=bufferNum && StaticBuffer::metainfo[i].free == false)
-        StaticBuffer::metainfo[i].timeStamp+=1;
-    }
-  }
-  else
+  // a pinned block stays in the buffer it was pinned in
+  if(this->pinDepth > 0)
   {
-    bufferNum = StaticBuffer::getFreeBuffer(this->blockNum);
-    if(bufferNum == E_OUTOFBOUND)
-      return bufferNum;
-    Disk::readBlock(StaticBuffer::blocks[bufferNum],this->blockNum);
+    *buffPtr = StaticBuffer::blocks[this->pinnedBuffer];
+    return SUCCESS;
   }
-  *buffPtr = StaticBuffer::blocks[bufferNum];
-    // else
-        // get a free buffer using StaticBuffer.getFreeBuffer()
 
-        // if the call returns E_OUTOFBOUND, return E_OUTOFBOUND here as
-        // the blockNum is invalid
+  // get the buffer holding the block using StaticBuffer::loadBlock(); if the
+  // block is not in the buffer yet, it is read into a free buffer
+  // (E_OUTOFBOUND if the blockNum is invalid)
+  int bufferNum = StaticBuffer::loadBlock(this->blockNum);
+  if(bufferNum < 0)
+    return bufferNum;
 
-        // Read the block into the free buffer using readBlock()
-
-    // store the pointer to this buffer (blocks[bufferNum]) in *buffPtr
+  // store the pointer to this buffer (blocks[bufferNum]) in *buffPtr
+  *buffPtr = StaticBuffer::blocks[bufferNum];
 
   return SUCCESS;
 }
@@ -160,14 +150,10 @@ int RecBuffer::getSlotMap(unsigned char *slotMap) {
     return ret;
   }
 
-  struct HeadInfo head;
-  // get the header of the block using getHeader() function
-  int retu = getHeader(&head);
-  if (retu != SUCCESS) {
-    return retu;
-  }
+  // the header is read straight from the buffer loaded above
+  struct HeadInfo *head = (struct HeadInfo *)bufferPtr;
 
-  int slotCount = head.numSlots;/* number of slots in block from header */
+  int slotCount = head->numSlots;/* number of slots in block from header */
 
   // get a pointer to the beginning of the slotmap in memory by offsetting HEADER_SIZE
   unsigned char *slotMapInBuffer = bufferPtr + HEADER_SIZE;
@@ -189,12 +175,11 @@ int RecBuffer::setRecord(union Attribute *rec, int slotNum) {
     }
     // if loadBlockAndGetBufferPtr(&bufferPtr) != SUCCESS
         // return the value returned by the call.
-    HeadInfo header;
-    this->getHeader(&header);
-    /* get the header of the block using the getHeader() function */
-    int no_attrs = header.numAttrs;
+    /* the header is read straight from the buffer loaded above */
+    HeadInfo *header = (HeadInfo *)bufferPtr;
+    int no_attrs = header->numAttrs;
     // get number of attributes in the block.
-    int no_slots = header.numSlots;
+    int no_slots = header->numSlots;
     // get the number of slots in the block.
 
     // if input slotNum is not in the permitted range return E_OUTOFBOUND.
@@ -270,7 +255,7 @@ int BlockBuffer::setBlockType(int blockType){
     // update the StaticBuffer::blockAllocMap entry corresponding to the
     // object's block number to `blockType`.
 
-    memcpy(&(StaticBuffer::blockAllocMap[this->blockNum]),bufferPtr,1);
+    StaticBuffer::setBlockAllocType(this->blockNum, blockType);
 
     // update dirty bit by calling StaticBuffer::setDirtyBit()INSERT INTO Locations VALUES (elhc, 300)
     temp = StaticBuffer::setDirtyBit(this->blockNum);
@@ -284,26 +269,19 @@ int BlockBuffer::setBlockType(int blockType){
 
 int BlockBuffer::getFreeBlock(int blockType){
 
-    // iterate through the StaticBuffer::blockAllocMap and find the block number
-    // of a free block in the disk.
-    int free_block=-1;
-    for(int i=0;i<DISK_BLOCKS;i++)
-    {
-      if(StaticBuffer::blockAllocMap[i] == UNUSED_BLK)
-      {
-        free_block = i;
-        break;
-      }
-    }
-    if(free_block == -1)
-      return E_DISKFULL;
-
+    // find the block number of a free block in the disk using
+    // StaticBuffer::findFreeBlock().
     // if no block is free, return E_DISKFULL.
+    int free_block = StaticBuffer::findFreeBlock();
+    if(free_block == E_DISKFULL)
+      return E_DISKFULL;
 
     // set the object's blockNum to the block number of the free block.
     this->blockNum = free_block;
     // find a free buffer using StaticBuffer::getFreeBuffer() .
     int bufferNum = StaticBuffer::getFreeBuffer(free_block);
+    if(bufferNum == E_BUFFERFULL)
+      return E_BUFFERFULL;
     // initialize the header of the block passing a struct HeadInfo with values
     // pblock: -1, lblock: -1, rblock: -1, numEntries: 0, numAttrs: 0, numSlots: 0
     // to the setHeader() function.
@@ -333,11 +311,10 @@ int RecBuffer::setSlotMap(unsigned char *slotMap) {
     if(temp!=SUCCESS)
       return temp;
 
-    // get the header of the block using the getHeader() function
-    struct HeadInfo header;
-    getHeader(&header);
+    // the header is read straight from the buffer loaded above
+    struct HeadInfo *header = (struct HeadInfo *)bufferPtr;
 
-    int numSlots = header.numSlots;/* the number of slots in the block */
+    int numSlots = header->numSlots;/* the number of slots in the block */
 
     // the slotmap starts at bufferPtr + HEADER_SIZE. Copy the contents of the
     // argument `slotMap` to the buffer replacing the existing slotmap.
@@ -354,6 +331,39 @@ int RecBuffer::setSlotMap(unsigned char *slotMap) {
     return SUCCESS;
 }
 
+/* Pins the block in its buffer (loading it if needed). Until the matching
+   unpin(), the buffer is not evicted and every method of this object uses it
+   without another lookup. Pins of the same object nest. */
+int BlockBuffer::pin(){
+  if(this->pinDepth > 0)
+  {
+    this->pinDepth++;
+    return SUCCESS;
+  }
+
+  unsigned char *bufferPtr;
+  int ret = loadBlockAndGetBufferPtr(&bufferPtr);
+  if(ret != SUCCESS)
+    return ret;
+
+  this->pinnedBuffer = StaticBuffer::getBufferNum(this->blockNum);
+  StaticBuffer::pinBuffer(this->pinnedBuffer);
+  this->pinDepth = 1;
+  return SUCCESS;
+}
+
+void BlockBuffer::unpin(){
+  if(this->pinDepth == 0)
+    return;
+
+  this->pinDepth--;
+  if(this->pinDepth == 0)
+  {
+    StaticBuffer::unpinBuffer(this->pinnedBuffer, this->blockNum);
+    this->pinnedBuffer = -1;
+  }
+}
+
 int BlockBuffer::getBlockNum(){
 
     //return corresponding block number.
@@ -379,15 +389,18 @@ void BlockBuffer::releaseBlock(){
         // to true.
         if(bufferNum!=E_BLOCKNOTINBUFFER)
         {
-          StaticBuffer::metainfo[bufferNum].free = true;
+          StaticBuffer::releaseBuffer(bufferNum);
         }
 
         // free the block in disk by setting the data type of the entry
         // corresponding to the block number in StaticBuffer::blockAllocMap
         // to UNUSED_BLK.
-        StaticBuffer::blockAllocMap[this->blockNum] = UNUSED_BLK;
+        StaticBuffer::setBlockAllocType(this->blockNum, UNUSED_BLK);
         // set the object's blockNum to INVALID_BLOCK (-1)
         this->blockNum = INVALID_BLOCKNUM;
+        // (any pin on the buffer went with it)
+        this->pinnedBuffer = -1;
+        this->pinDepth = 0;
         return;
 }
 
@@ -408,6 +421,247 @@ int compareAttrs(union Attribute attr1, union Attribute attr2, int attrType) {
     return 0;
 }
 
+void normalizeKey(Attribute *key, int attrType) {
+    if (attrType == STRING) {
+        size_t length = strnlen(key->sVal, ATTR_SIZE);
+        memset(key->sVal + length, 0, ATTR_SIZE - length);
+        return;
+    }
+
+    // -0.0 == 0.0, so both get the encoding of 0.0
+    if (key->nVal == 0)
+        key->nVal = 0;
+    uint64_t bits;
+    memcpy(&bits, &key->nVal, sizeof(bits));
+    if (bits >> 63)
+        bits = ~bits;
+    else
+        bits |= (uint64_t)1 << 63;
+
+    unsigned char *encoded = (unsigned char *)key + sizeof(double);
+    for (int i = 0; i < 8; i++)
+        encoded[i] = bits >> (56 - 8 * i);
+}
+
+// offset and length of the bytes compared for a key of attrType
+#define KEY_CMP_OFFSET(attrType) ((attrType) == NUMBER ? (int)sizeof(double) : 0)
+#define KEY_CMP_LENGTH(attrType) ((attrType) == NUMBER ? 8 : ATTR_SIZE)
+
+/* compares two keys normalized with normalizeKey() */
+int compareKeys(const Attribute *key1, const Attribute *key2, int attrType) {
+    int offset = KEY_CMP_OFFSET(attrType);
+    return memcmp((const char *)key1 + offset, (const char *)key2 + offset, KEY_CMP_LENGTH(attrType));
+}
+
+/*
+Binary search over the sorted keys of an index block, read straight from the
+buffer: returns the index of the first entry whose key is >= attrVal (> attrVal
+if strict), or numEntries if there is none. attrVal must be normalized.
+*/
+static int lowerBoundInBlock(unsigned char *bufferPtr, int entrySize, int keyOffset,
+                             Attribute attrVal, int attrType, bool strict) {
+    int numEntries = ((struct HeadInfo *)bufferPtr)->numEntries;
+    int cmpOffset = KEY_CMP_OFFSET(attrType);
+    int cmpLength = KEY_CMP_LENGTH(attrType);
+    const char *target = (const char *)&attrVal + cmpOffset;
+    int low = 0, high = numEntries;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        unsigned char *key = bufferPtr + HEADER_SIZE + mid * entrySize + keyOffset;
+        int cmp = memcmp(key + cmpOffset, target, cmpLength);
+        if (cmp > 0 || (cmp == 0 && !strict))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+/*
+An internal block in INTERNAL_LAYOUT_NUMBER keeps the nVal of its keys in an
+array of MAX_KEYS_INTERNAL doubles right after the header, followed by the
+MAX_KEYS_INTERNAL + 1 children (child i is the lChild of entry i and the rChild
+of entry i - 1). The keys being contiguous lets the search compare several of
+them at once with SSE2/AVX2.
+*/
+#define NUMBER_KEYS_OFFSET HEADER_SIZE
+#define NUMBER_CHILDREN_OFFSET (HEADER_SIZE + MAX_KEYS_INTERNAL * (int)sizeof(double))
+
+/*
+Searches for the index of the first of the numKeys sorted keys that is >= target
+(> target if strict). The vector versions compare whole vectors of keys, which
+may read past numKeys but never past the MAX_KEYS_INTERNAL keys of the block
+(a multiple of 4); the result is capped at numKeys.
+*/
+typedef int (*NumberKeySearch)(const double *keys, int numKeys, double target, bool strict);
+
+static int searchNumberKeysScalar(const double *keys, int numKeys, double target, bool strict) {
+    int low = 0, high = numKeys;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (keys[mid] > target || (keys[mid] == target && !strict))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+static int searchNumberKeysSSE2(const double *keys, int numKeys, double target, bool strict) {
+    __m128d value = _mm_set1_pd(target);
+    for (int i = 0; i < numKeys; i += 2) {
+        __m128d key = _mm_loadu_pd(keys + i);
+        // bit k is set if keys[i + k] is still below target
+        int below = _mm_movemask_pd(strict ? _mm_cmple_pd(key, value) : _mm_cmplt_pd(key, value));
+        if (below != 0x3) {
+            int index = i + __builtin_ctz(~below);
+            return index < numKeys ? index : numKeys;
+        }
+    }
+    return numKeys;
+}
+
+__attribute__((target("avx2")))
+static int searchNumberKeysAVX2(const double *keys, int numKeys, double target, bool strict) {
+    __m256d value = _mm256_set1_pd(target);
+    for (int i = 0; i < numKeys; i += 4) {
+        __m256d key = _mm256_loadu_pd(keys + i);
+        int below = _mm256_movemask_pd(strict ? _mm256_cmp_pd(key, value, _CMP_LE_OQ)
+                                              : _mm256_cmp_pd(key, value, _CMP_LT_OQ));
+        if (below != 0xF) {
+            int index = i + __builtin_ctz(~below);
+            return index < numKeys ? index : numKeys;
+        }
+    }
+    return numKeys;
+}
+#endif
+
+// picks the widest search the CPU we are running on supports
+// (NITCBASE_KEY_SEARCH=scalar forces the scalar one, e.g. to compare them)
+static NumberKeySearch chooseNumberKeySearch() {
+    const char *forced = getenv("NITCBASE_KEY_SEARCH");
+    if (forced != nullptr && strcmp(forced, "scalar") == 0)
+        return searchNumberKeysScalar;
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return searchNumberKeysAVX2;
+    return searchNumberKeysSSE2;
+#else
+    return searchNumberKeysScalar;
+#endif
+}
+
+static const NumberKeySearch searchNumberKeys = chooseNumberKeySearch();
+
+/* index of the first entry with key >= attrVal (> if strict), numEntries if none */
+int IndInternal::lowerBound(Attribute attrVal, int attrType, bool strict) {
+    unsigned char *bufferPtr;
+    int ret = loadBlockAndGetBufferPtr(&bufferPtr);
+    if(ret!=SUCCESS)
+      return ret;
+
+    struct HeadInfo *header = (struct HeadInfo *)bufferPtr;
+    if (header->numSlots == INTERNAL_LAYOUT_NUMBER)
+        return searchNumberKeys((const double *)(bufferPtr + NUMBER_KEYS_OFFSET),
+                                header->numEntries, attrVal.nVal, strict);
+
+    // entry i is {lChild, attrVal} at HEADER_SIZE + i*20 (rChild is the next lChild)
+    return lowerBoundInBlock(bufferPtr, 20, 4, attrVal, attrType, strict);
+}
+
+/*
+A leaf in LEAF_LAYOUT_PREFIX holds, right after the header:
+  prefixLength (1 byte), suffixLength (1 byte), the prefixLength bytes every key
+  starts with, and then for entry i the next suffixLength bytes of its key, its
+  block (2 bytes) and its slot (2 bytes).
+Keys are normalized (zero-padded), so the bytes of a key after prefixLength +
+suffixLength are zero and need not be stored. DISK_BLOCKS and the number of
+slots in a block both fit in 2 bytes.
+*/
+#define PREFIX_LEAF_LENGTHS HEADER_SIZE
+#define PREFIX_LEAF_PREFIX (HEADER_SIZE + 2)
+#define PREFIX_LEAF_POINTER_SIZE 4
+
+static_assert(DISK_BLOCKS <= 65536, "block numbers of a prefix leaf are stored in 2 bytes");
+
+// prefix and suffix lengths with which entries[0..numEntries) are stored
+static void prefixLayoutOf(Index entries[], int numEntries, int *prefixLength, int *suffixLength) {
+    if (numEntries == 0) {
+        *prefixLength = 0;
+        *suffixLength = 0;
+        return;
+    }
+
+    int common = ATTR_SIZE, longest = 0;
+    for (int i = 0; i < numEntries; i++) {
+        const char *key = entries[i].attrVal.sVal;
+        int length = strnlen(key, ATTR_SIZE);
+        if (length > longest)
+            longest = length;
+        int j = 0;
+        while (j < common && key[j] == entries[0].attrVal.sVal[j])
+            j++;
+        common = j;
+    }
+    *prefixLength = common < longest ? common : longest;
+    *suffixLength = longest - *prefixLength;
+}
+
+/* bytes after the header taken by entries[0..numEntries) in LEAF_LAYOUT_PREFIX */
+int IndLeaf::prefixLayoutSize(Index entries[], int numEntries) {
+    int prefixLength, suffixLength;
+    prefixLayoutOf(entries, numEntries, &prefixLength, &suffixLength);
+    return 2 + prefixLength + numEntries * (suffixLength + PREFIX_LEAF_POINTER_SIZE);
+}
+
+/* index of the first entry with key >= attrVal (> if strict), numEntries if none */
+int IndLeaf::lowerBound(Attribute attrVal, int attrType, bool strict) {
+    unsigned char *bufferPtr;
+    int ret = loadBlockAndGetBufferPtr(&bufferPtr);
+    if(ret!=SUCCESS)
+      return ret;
+
+    struct HeadInfo *header = (struct HeadInfo *)bufferPtr;
+    if (header->numSlots != LEAF_LAYOUT_PREFIX)
+        return lowerBoundInBlock(bufferPtr, LEAF_ENTRY_SIZE, 0, attrVal, attrType, strict);
+
+    int prefixLength = bufferPtr[PREFIX_LEAF_LENGTHS];
+    int suffixLength = bufferPtr[PREFIX_LEAF_LENGTHS + 1];
+    unsigned char *suffixes = bufferPtr + PREFIX_LEAF_PREFIX + prefixLength;
+    int entrySize = suffixLength + PREFIX_LEAF_POINTER_SIZE;
+    const char *target = attrVal.sVal;
+
+    // every key starts with the prefix: compare it once
+    int cmp = memcmp(bufferPtr + PREFIX_LEAF_PREFIX, target, prefixLength);
+    if (cmp > 0)
+        return 0;
+    if (cmp < 0)
+        return header->numEntries;
+
+    // the keys are zero past the suffix; a target that is not is larger than
+    // any key it agrees with up to there
+    bool targetLonger = false;
+    for (int i = prefixLength + suffixLength; i < ATTR_SIZE; i++)
+        if (target[i] != 0)
+            targetLonger = true;
+
+    int low = 0, high = header->numEntries;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        cmp = memcmp(suffixes + mid * entrySize, target + prefixLength, suffixLength);
+        if (cmp == 0 && targetLonger)
+            cmp = -1;
+        if (cmp > 0 || (cmp == 0 && !strict))
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
 int IndInternal::getEntry(void *ptr, int indexNum) {
     // if the indexNum is not in the valid range of [0, MAX_KEYS_INTERNAL-1]
     //     return E_OUTOFBOUND.
@@ -438,6 +692,16 @@ int IndInternal::getEntry(void *ptr, int indexNum) {
     /* the indexNum'th entry will begin at an offset of
        HEADER_SIZE + (indexNum * (sizeof(int) + ATTR_SIZE) )         [why?]
        from bufferPtr */
+    if (((struct HeadInfo *)bufferPtr)->numSlots == INTERNAL_LAYOUT_NUMBER) {
+        // only nVal is stored; the rest of the key is derived from it again
+        unsigned char *childPtr = bufferPtr + NUMBER_CHILDREN_OFFSET + indexNum * 4;
+        memcpy(&(internalEntry->lChild), childPtr, 4);
+        memcpy(&(internalEntry->attrVal.nVal), bufferPtr + NUMBER_KEYS_OFFSET + indexNum * 8, 8);
+        normalizeKey(&(internalEntry->attrVal), NUMBER);
+        memcpy(&(internalEntry->rChild), childPtr + 4, 4);
+        return SUCCESS;
+    }
+
     unsigned char *entryPtr = bufferPtr + HEADER_SIZE + (indexNum * 20);
 
     memcpy(&(internalEntry->lChild), entryPtr, sizeof(int32_t));
@@ -450,9 +714,9 @@ int IndInternal::getEntry(void *ptr, int indexNum) {
 
 int IndLeaf::getEntry(void *ptr, int indexNum) {
 
-    // if the indexNum is not in the valid range of [0, MAX_KEYS_LEAF-1]
-    //     return E_OUTOFBOUND.
-    if(indexNum<0 || indexNum >= MAX_KEYS_LEAF)
+    // if the indexNum is not in the valid range of [0, MAX_KEYS_LEAF_PREFIX-1]
+    //     return E_OUTOFBOUND. (plain leaves only go up to MAX_KEYS_LEAF-1)
+    if(indexNum<0 || indexNum >= MAX_KEYS_LEAF_PREFIX)
       return E_OUTOFBOUND;
 
     unsigned char *bufferPtr;
@@ -465,6 +729,28 @@ int IndLeaf::getEntry(void *ptr, int indexNum) {
     if(ret!=SUCCESS)
       return ret;
 
+    if (((struct HeadInfo *)bufferPtr)->numSlots == LEAF_LAYOUT_PREFIX) {
+        // put the key back together from the prefix and the entry's suffix
+        struct Index *index = (struct Index *)ptr;
+        int prefixLength = bufferPtr[PREFIX_LEAF_LENGTHS];
+        int suffixLength = bufferPtr[PREFIX_LEAF_LENGTHS + 1];
+        unsigned char *entryPtr = bufferPtr + PREFIX_LEAF_PREFIX + prefixLength
+                                  + indexNum * (suffixLength + PREFIX_LEAF_POINTER_SIZE);
+
+        memset(index, 0, sizeof(struct Index));
+        memcpy(index->attrVal.sVal, bufferPtr + PREFIX_LEAF_PREFIX, prefixLength);
+        memcpy(index->attrVal.sVal + prefixLength, entryPtr, suffixLength);
+        uint16_t block, slot;
+        memcpy(&block, entryPtr + suffixLength, 2);
+        memcpy(&slot, entryPtr + suffixLength + 2, 2);
+        index->block = block;
+        index->slot = slot;
+        return SUCCESS;
+    }
+
+    if(indexNum >= MAX_KEYS_LEAF)
+      return E_OUTOFBOUND;
+
     // copy the indexNum'th Index entry in buffer to memory ptr using memcpy
 
     /* the indexNum'th entry will begin at an offset of
@@ -478,9 +764,9 @@ int IndLeaf::getEntry(void *ptr, int indexNum) {
 
 int IndLeaf::setEntry(void *ptr, int indexNum) {
 
-    // if the indexNum is not in the valid range of [0, MAX_KEYS_LEAF-1]
-    //     return E_OUTOFBOUND.
-  if(indexNum<0 || indexNum >= MAX_KEYS_LEAF)
+    // if the indexNum is not in the valid range of [0, MAX_KEYS_LEAF_PREFIX-1]
+    //     return E_OUTOFBOUND. (plain leaves only go up to MAX_KEYS_LEAF-1)
+    if(indexNum<0 || indexNum >= MAX_KEYS_LEAF_PREFIX)
       return E_OUTOFBOUND;
 
     unsigned char *bufferPtr;
@@ -493,6 +779,21 @@ int IndLeaf::setEntry(void *ptr, int indexNum) {
     if(ret!=SUCCESS)
       return ret;
 
+    if (((struct HeadInfo *)bufferPtr)->numSlots == LEAF_LAYOUT_PREFIX) {
+        // only an existing entry can be replaced; the whole leaf is rewritten
+        int numEntries = ((struct HeadInfo *)bufferPtr)->numEntries;
+        if (indexNum >= numEntries)
+            return E_OUTOFBOUND;
+        Index entries[numEntries];
+        for (int i = 0; i < numEntries; i++)
+            getEntry(&entries[i], i);
+        entries[indexNum] = *(struct Index *)ptr;
+        return setEntries(entries, numEntries);
+    }
+
+    if(indexNum >= MAX_KEYS_LEAF)
+      return E_OUTOFBOUND;
+
     // copy the Index at ptr to indexNum'th entry in the buffer using memcpy
 
     /* the indexNum'th entry will begin at an offset of
@@ -508,6 +809,58 @@ int IndLeaf::setEntry(void *ptr, int indexNum) {
     return ret;
 }
 
+/* whether entries[0..numEntries) (sorted by key) fit in the leaf, in its layout */
+bool IndLeaf::fits(Index entries[], int numEntries) {
+    HeadInfo header;
+    if (getHeader(&header) != SUCCESS)
+        return false;
+    if (header.numSlots != LEAF_LAYOUT_PREFIX)
+        return numEntries <= MAX_KEYS_LEAF;
+    return numEntries <= MAX_KEYS_LEAF_PREFIX
+           && prefixLayoutSize(entries, numEntries) <= BLOCK_SIZE - HEADER_SIZE;
+}
+
+/*
+Replaces the entries of the leaf with entries[0..numEntries) (sorted by key) and
+sets numEntries in its header. Returns E_OUTOFBOUND, leaving the block as it
+was, if they do not fit: more than MAX_KEYS_LEAF entries in a plain leaf, or
+more than MAX_KEYS_LEAF_PREFIX entries or a block's worth of bytes in a prefix
+leaf.
+*/
+int IndLeaf::setEntries(Index entries[], int numEntries) {
+    if (!fits(entries, numEntries))
+        return E_OUTOFBOUND;
+
+    unsigned char *bufferPtr;
+    int ret = loadBlockAndGetBufferPtr(&bufferPtr);
+    if(ret!=SUCCESS)
+      return ret;
+
+    struct HeadInfo *header = (struct HeadInfo *)bufferPtr;
+    if (header->numSlots != LEAF_LAYOUT_PREFIX) {
+        memcpy(bufferPtr + HEADER_SIZE, entries, numEntries * LEAF_ENTRY_SIZE);
+    } else {
+        int prefixLength, suffixLength;
+        prefixLayoutOf(entries, numEntries, &prefixLength, &suffixLength);
+        bufferPtr[PREFIX_LEAF_LENGTHS] = prefixLength;
+        bufferPtr[PREFIX_LEAF_LENGTHS + 1] = suffixLength;
+        if (numEntries > 0)
+            memcpy(bufferPtr + PREFIX_LEAF_PREFIX, entries[0].attrVal.sVal, prefixLength);
+
+        unsigned char *entryPtr = bufferPtr + PREFIX_LEAF_PREFIX + prefixLength;
+        for (int i = 0; i < numEntries; i++) {
+            uint16_t block = entries[i].block, slot = entries[i].slot;
+            memcpy(entryPtr, entries[i].attrVal.sVal + prefixLength, suffixLength);
+            memcpy(entryPtr + suffixLength, &block, 2);
+            memcpy(entryPtr + suffixLength + 2, &slot, 2);
+            entryPtr += suffixLength + PREFIX_LEAF_POINTER_SIZE;
+        }
+    }
+    header->numEntries = numEntries;
+
+    return StaticBuffer::setDirtyBit(this->blockNum);
+}
+
 int IndInternal::setEntry(void *ptr, int indexNum) {
     // if the indexNum is not in the valid range of [0, MAX_KEYS_INTERNAL-1]
     //     return E_OUTOFBOUND.
@@ -539,11 +892,18 @@ int IndInternal::setEntry(void *ptr, int indexNum) {
        HEADER_SIZE + (indexNum * (sizeof(int) + ATTR_SIZE) )         [why?]
        from bufferPtr */
 
-    unsigned char *entryPtr = bufferPtr + HEADER_SIZE + (indexNum * 20);
-
-    memcpy(entryPtr, &(internalEntry->lChild), 4);
-    memcpy(entryPtr + 4, &(internalEntry->attrVal), ATTR_SIZE);
-    memcpy(entryPtr + 20, &(internalEntry->rChild), 4);
+    if (((struct HeadInfo *)bufferPtr)->numSlots == INTERNAL_LAYOUT_NUMBER) {
+        unsigned char *childPtr = bufferPtr + NUMBER_CHILDREN_OFFSET + indexNum * 4;
+        memcpy(childPtr, &(internalEntry->lChild), 4);
+        memcpy(bufferPtr + NUMBER_KEYS_OFFSET + indexNum * 8, &(internalEntry->attrVal.nVal), 8);
+        memcpy(childPtr + 4, &(internalEntry->rChild), 4);
+    } else {
+        unsigned char *entryPtr = bufferPtr + HEADER_SIZE + (indexNum * 20);
+
+        memcpy(entryPtr, &(internalEntry->lChild), 4);
+        memcpy(entryPtr + 4, &(internalEntry->attrVal), ATTR_SIZE);
+        memcpy(entryPtr + 20, &(internalEntry->rChild), 4);
+    }
 
 
     // update dirty bit using setDirtyBit()
@@ -25,6 +25,17 @@ typedef union Attribute {
 
 int compareAttrs(Attribute attr1, Attribute attr2, int attrType);
 
+/*
+B+ tree keys are kept in an order-preserving form so that two keys of the same
+type compare with a single memcmp of a fixed number of bytes:
+  NUMBER: nVal stays in bytes 0-7 (so the value can still be read) and bytes
+          8-15 hold its bits big-endian, with the sign bit flipped for positive
+          numbers and every bit flipped for negative ones
+  STRING: the bytes after the terminating '\0' are zeroed
+*/
+void normalizeKey(Attribute *key, int attrType);
+int compareKeys(const Attribute *key1, const Attribute *key2, int attrType);
+
 struct InternalEntry {
   int32_t lChild;
   union Attribute attrVal;
@@ -42,6 +53,9 @@ class BlockBuffer {
  protected:
   // field
   int blockNum;
+  // buffer holding the block while this object has it pinned (see pin())
+  int pinnedBuffer;
+  int pinDepth;
   // methods
   int loadBlockAndGetBufferPtr(unsigned char **buffPtr);
   int getFreeBlock(int blockType);
@@ -54,9 +68,38 @@ class BlockBuffer {
   int getBlockNum();
   int getHeader(struct HeadInfo *head);
   int setHeader(struct HeadInfo *head);
+  int pin();
+  void unpin();
   void releaseBlock();
 };
 
+/*
+Pins the block of a BlockBuffer for as long as the guard is in scope, so that
+every access through the BlockBuffer in the meantime uses the same buffer
+without looking the block up again.
+
+    RecBuffer recBuffer(block);
+    PageGuard guard(recBuffer);
+    // getHeader(), getSlotMap() and getRecord() now share one buffer lookup
+*/
+class PageGuard {
+ private:
+  BlockBuffer *block;
+  int status;
+
+ public:
+  PageGuard(BlockBuffer &blockBuffer) : block(&blockBuffer) { status = block->pin(); }
+  ~PageGuard() {
+    if (status == SUCCESS)
+      block->unpin();
+  }
+  // SUCCESS, or the error with which the block could not be loaded
+  int getStatus() { return status; }
+
+  PageGuard(const PageGuard &) = delete;
+  PageGuard &operator=(const PageGuard &) = delete;
+};
+
 class RecBuffer : public BlockBuffer {
  public:
   // methods
@@ -76,20 +119,39 @@ class IndBuffer : public BlockBuffer {
   virtual int setEntry(void *ptr, int indexNum) = 0;
 };
 
+/*
+An internal index block stores its entries in one of two layouts, given by the
+numSlots field of its header: INTERNAL_LAYOUT_INTERLEAVED ({lChild, key} pairs)
+or INTERNAL_LAYOUT_NUMBER (NUMBER keys and children in separate arrays, searched
+with SIMD compares). getEntry() and setEntry() hide the difference.
+*/
 class IndInternal : public IndBuffer {
  public:
   IndInternal();
   IndInternal(int blockNum);
   int getEntry(void *ptr, int indexNum);
   int setEntry(void *ptr, int indexNum);
+  int lowerBound(Attribute attrVal, int attrType, bool strict);
 };
 
+/*
+A leaf index block stores its entries in one of two layouts, given by the
+numSlots field of its header: LEAF_LAYOUT_PLAIN (Index entries as they are) or
+LEAF_LAYOUT_PREFIX (STRING keys only: the prefix common to all keys is stored
+once, followed by fixed-width key suffixes and 2-byte block and slot numbers).
+A prefix leaf is rewritten as a whole with setEntries(), since one new key can
+change the prefix of every entry.
+*/
 class IndLeaf : public IndBuffer {
  public:
   IndLeaf();
   IndLeaf(int blockNum);
   int getEntry(void *ptr, int indexNum);
   int setEntry(void *ptr, int indexNum);
+  int setEntries(Index entries[], int numEntries);
+  bool fits(Index entries[], int numEntries);
+  int lowerBound(Attribute attrVal, int attrType, bool strict);
+  static int prefixLayoutSize(Index entries[], int numEntries);
 };
 
 #endif  // NITCBASE_BLOCKBUFFER_H
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "ReplacementPolicy.h"
+// the declarations for these classes can be found at "ReplacementPolicy.h"
+
+#include "../define/constants.h"
+#include "StaticBuffer.h"
+
+ReplacementPolicy *ReplacementPolicy::create(int policyType, int capacity) {
+  if (policyType == BUFFER_POLICY_LRU)
+    return new LruPolicy(capacity);
+  if (policyType == BUFFER_POLICY_2Q)
+    return new TwoQueuePolicy(capacity);
+  return new ClockPolicy(capacity);
+}
+
+ClockPolicy::ClockPolicy(int capacity)
+    : referenced(capacity, 0), occupied(capacity, 0), hand(0) {}
+
+void ClockPolicy::onLoad(int bufferNum, int blockNum) {
+  occupied[bufferNum] = 1;
+  referenced[bufferNum] = 1;
+}
+
+void ClockPolicy::onHit(int bufferNum) {
+  referenced[bufferNum] = 1;
+}
+
+void ClockPolicy::onRelease(int bufferNum) {
+  occupied[bufferNum] = 0;
+  referenced[bufferNum] = 0;
+}
+
+/*
+Sweeps the hand over the frames, clearing reference bits, until it finds an
+unpinned occupied frame that has not been referenced since the last sweep.
+Every frame is passed at most twice.
+*/
+int ClockPolicy::pickVictim(const struct BufferMetaInfo *metainfo) {
+  int capacity = referenced.size();
+  for (int step = 0; step < 2 * capacity; step++) {
+    int bufferNum = hand;
+    hand = (hand + 1) % capacity;
+    if (!occupied[bufferNum] || metainfo[bufferNum].pinCount > 0)
+      continue;
+    if (referenced[bufferNum]) {
+      referenced[bufferNum] = 0;
+      continue;
+    }
+    return bufferNum;
+  }
+  return -1;
+}
+
+LruPolicy::LruPolicy(int capacity) : lastUsed(capacity, -1), clock(0) {}
+
+void LruPolicy::onLoad(int bufferNum, int blockNum) {
+  lastUsed[bufferNum] = ++clock;
+}
+
+void LruPolicy::onHit(int bufferNum) {
+  lastUsed[bufferNum] = ++clock;
+}
+
+void LruPolicy::onRelease(int bufferNum) {
+  lastUsed[bufferNum] = -1;
+}
+
+int LruPolicy::pickVictim(const struct BufferMetaInfo *metainfo) {
+  int victim = -1;
+  for (int i = 0; i < (int)lastUsed.size(); i++) {
+    if (lastUsed[i] == -1 || metainfo[i].pinCount > 0)
+      continue;
+    if (victim == -1 || lastUsed[i] < lastUsed[victim])
+      victim = i;
+  }
+  return victim;
+}
+
+/*
+A1in gets a quarter of the frames and A1out remembers half as many blocks as
+there are frames, the sizes suggested in the 2Q paper.
+*/
+TwoQueuePolicy::TwoQueuePolicy(int capacity)
+    : prev(capacity, -1), next(capacity, -1), list(capacity, LIST_NONE),
+      frameBlock(capacity, -1), ghostHead(0), ghostSeqCounter(0),
+      ghostSeq(DISK_BLOCKS, -1) {
+  a1in = {-1, -1, 0};
+  am = {-1, -1, 0};
+  kin = capacity / 4 > 0 ? capacity / 4 : 1;
+  kout = capacity / 2 > 0 ? capacity / 2 : 1;
+}
+
+void TwoQueuePolicy::pushFront(FrameList &frames, int bufferNum) {
+  prev[bufferNum] = -1;
+  next[bufferNum] = frames.head;
+  if (frames.head != -1)
+    prev[frames.head] = bufferNum;
+  frames.head = bufferNum;
+  if (frames.tail == -1)
+    frames.tail = bufferNum;
+  frames.size++;
+}
+
+void TwoQueuePolicy::unlink(FrameList &frames, int bufferNum) {
+  if (prev[bufferNum] != -1)
+    next[prev[bufferNum]] = next[bufferNum];
+  else
+    frames.head = next[bufferNum];
+  if (next[bufferNum] != -1)
+    prev[next[bufferNum]] = prev[bufferNum];
+  else
+    frames.tail = prev[bufferNum];
+  prev[bufferNum] = next[bufferNum] = -1;
+  frames.size--;
+}
+
+/* adds the block to A1out, forgetting the oldest block if A1out is full */
+void TwoQueuePolicy::remember(int blockNum) {
+  if (blockNum < 0 || blockNum >= DISK_BLOCKS)
+    return;
+  ghostSeq[blockNum] = ghostSeqCounter;
+  ghostQueue.push_back({blockNum, ghostSeqCounter++});
+
+  while ((int)ghostQueue.size() - ghostHead > kout) {
+    std::pair<int, int> oldest = ghostQueue[ghostHead++];
+    if (ghostSeq[oldest.first] == oldest.second)
+      ghostSeq[oldest.first] = -1;
+  }
+  // drop the consumed part of the queue once it is as large as the rest
+  if (ghostHead > kout) {
+    ghostQueue.erase(ghostQueue.begin(), ghostQueue.begin() + ghostHead);
+    ghostHead = 0;
+  }
+}
+
+void TwoQueuePolicy::onLoad(int bufferNum, int blockNum) {
+  if (list[bufferNum] == LIST_A1IN)
+    unlink(a1in, bufferNum);
+  else if (list[bufferNum] == LIST_AM)
+    unlink(am, bufferNum);
+
+  frameBlock[bufferNum] = blockNum;
+  if (blockNum >= 0 && blockNum < DISK_BLOCKS && ghostSeq[blockNum] != -1) {
+    // read again shortly after being evicted from A1in: a reused block
+    ghostSeq[blockNum] = -1;
+    list[bufferNum] = LIST_AM;
+    pushFront(am, bufferNum);
+  } else {
+    list[bufferNum] = LIST_A1IN;
+    pushFront(a1in, bufferNum);
+  }
+}
+
+void TwoQueuePolicy::onHit(int bufferNum) {
+  if (list[bufferNum] == LIST_AM) {
+    unlink(am, bufferNum);
+    pushFront(am, bufferNum);
+  }
+}
+
+void TwoQueuePolicy::onRelease(int bufferNum) {
+  if (list[bufferNum] == LIST_A1IN)
+    unlink(a1in, bufferNum);
+  else if (list[bufferNum] == LIST_AM)
+    unlink(am, bufferNum);
+  list[bufferNum] = LIST_NONE;
+  frameBlock[bufferNum] = -1;
+}
+
+/*
+Evicts the oldest block of A1in (remembering it in A1out) while A1in holds more
+than its share of the frames, and the least recently used block of Am otherwise.
+Pinned frames are stepped over, falling back to the other list if all the
+frames of one list are pinned.
+*/
+int TwoQueuePolicy::pickVictim(const struct BufferMetaInfo *metainfo) {
+  int a1inVictim = a1in.tail;
+  while (a1inVictim != -1 && metainfo[a1inVictim].pinCount > 0)
+    a1inVictim = prev[a1inVictim];
+  int amVictim = am.tail;
+  while (amVictim != -1 && metainfo[amVictim].pinCount > 0)
+    amVictim = prev[amVictim];
+
+  if (a1inVictim != -1 && (a1in.size > kin || amVictim == -1)) {
+    remember(frameBlock[a1inVictim]);
+    return a1inVictim;
+  }
+  return amVictim;
+}
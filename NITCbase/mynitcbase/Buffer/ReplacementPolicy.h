@@ -0,0 +1,104 @@
+#ifndef NITCBASE_REPLACEMENTPOLICY_H
+#define NITCBASE_REPLACEMENTPOLICY_H
+
+#include <vector>
+
+struct BufferMetaInfo;
+
+/* buffer replacement policies that StaticBuffer can be started with */
+enum BufferPolicyType {
+  BUFFER_POLICY_CLOCK = 0,  // second chance: a hit only sets a reference bit
+  BUFFER_POLICY_LRU = 1,    // evict the least recently used frame (the original timestamp scheme)
+  BUFFER_POLICY_2Q = 2      // scan resistant: blocks touched once never push out reused blocks
+};
+
+/*
+Decides which occupied buffer frame is evicted when StaticBuffer runs out of
+free frames. StaticBuffer tells the policy about every load, hit and release
+of a frame; free and pinned frames must never be returned as victims.
+*/
+class ReplacementPolicy {
+ public:
+  virtual ~ReplacementPolicy() {}
+  // the block blockNum was read into the (previously free or evicted) frame
+  virtual void onLoad(int bufferNum, int blockNum) = 0;
+  // the block in the frame was accessed again
+  virtual void onHit(int bufferNum) = 0;
+  // the frame was freed without being chosen as a victim
+  virtual void onRelease(int bufferNum) = 0;
+  // returns the occupied, unpinned frame to evict (-1 if every frame is pinned)
+  virtual int pickVictim(const struct BufferMetaInfo *metainfo) = 0;
+
+  static ReplacementPolicy *create(int policyType, int capacity);
+};
+
+class ClockPolicy : public ReplacementPolicy {
+ private:
+  std::vector<unsigned char> referenced;
+  std::vector<unsigned char> occupied;
+  int hand;
+
+ public:
+  ClockPolicy(int capacity);
+  void onLoad(int bufferNum, int blockNum);
+  void onHit(int bufferNum);
+  void onRelease(int bufferNum);
+  int pickVictim(const struct BufferMetaInfo *metainfo);
+};
+
+class LruPolicy : public ReplacementPolicy {
+ private:
+  // logical time of the last access of every frame (-1 if the frame is free)
+  std::vector<long long> lastUsed;
+  long long clock;
+
+ public:
+  LruPolicy(int capacity);
+  void onLoad(int bufferNum, int blockNum);
+  void onHit(int bufferNum);
+  void onRelease(int bufferNum);
+  int pickVictim(const struct BufferMetaInfo *metainfo);
+};
+
+/*
+The simplified 2Q policy of Johnson and Shasha. A block read for the first time
+goes to the A1in FIFO, which holds about a quarter of the frames; hits in A1in
+do not promote the block. When a block is evicted from A1in, its block number
+is remembered in the A1out ghost queue. A block that is read again while still
+in A1out has been reused and goes to the Am LRU list. A sequential scan
+therefore only cycles through A1in, and the catalog and index blocks in Am
+stay in the buffer.
+*/
+class TwoQueuePolicy : public ReplacementPolicy {
+ private:
+  enum { LIST_NONE = 0, LIST_A1IN = 1, LIST_AM = 2 };
+  // frames of A1in and Am as doubly linked lists (most recent at the head)
+  struct FrameList {
+    int head, tail, size;
+  };
+  std::vector<int> prev, next;
+  std::vector<unsigned char> list;
+  std::vector<int> frameBlock;
+  FrameList a1in, am;
+  int kin, kout;
+
+  // A1out: block numbers with the sequence number they were queued with; a
+  // block is in A1out while ghostSeq[blockNum] matches its queue entry
+  std::vector<std::pair<int, int>> ghostQueue;
+  int ghostHead;
+  int ghostSeqCounter;
+  std::vector<int> ghostSeq;
+
+  void pushFront(FrameList &frames, int bufferNum);
+  void unlink(FrameList &frames, int bufferNum);
+  void remember(int blockNum);
+
+ public:
+  TwoQueuePolicy(int capacity);
+  void onLoad(int bufferNum, int blockNum);
+  void onHit(int bufferNum);
+  void onRelease(int bufferNum);
+  int pickVictim(const struct BufferMetaInfo *metainfo);
+};
+
+#endif  // NITCBASE_REPLACEMENTPOLICY_H
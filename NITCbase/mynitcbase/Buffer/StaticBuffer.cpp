@@ -1,93 +1,356 @@
 #include "StaticBuffer.h"
 // the declarations for this class can be found at "StaticBuffer.h"
 
-unsigned char StaticBuffer::blocks[BUFFER_CAPACITY][BLOCK_SIZE];
-struct BufferMetaInfo StaticBuffer::metainfo[BUFFER_CAPACITY];
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "BlockBuffer.h"
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+// enough frames for the blocks that are pinned at the same time, plus the ones they load
+#define MIN_BUFFER_CAPACITY 8
+
+unsigned char (*StaticBuffer::blocks)[BLOCK_SIZE] = nullptr;
+struct BufferMetaInfo *StaticBuffer::metainfo = nullptr;
+int StaticBuffer::bufferCapacity = 0;
+size_t StaticBuffer::arenaSize = 0;
+bool StaticBuffer::arenaMapped = false;
+std::vector<int> StaticBuffer::freeBuffers;
+ReplacementPolicy *StaticBuffer::policy = nullptr;
+BufferStats StaticBuffer::stats = {0, 0, 0, 0, 0, 0, 0};
+std::mutex StaticBuffer::bufferLock;
+std::condition_variable StaticBuffer::writerWake;
+std::thread StaticBuffer::writerThread;
+bool StaticBuffer::writerRunning = false;
+bool StaticBuffer::writerStop = false;
+int StaticBuffer::readAheadBlocks = 0;
+std::condition_variable StaticBuffer::loadDone;
+std::condition_variable StaticBuffer::prefetchWake;
+std::thread StaticBuffer::prefetchThread;
+bool StaticBuffer::prefetchStop = false;
+int StaticBuffer::prefetchStart = -1;
+int StaticBuffer::prefetchType = REC;
+int StaticBuffer::chainLastBlock[2] = {-1, -1};
+int StaticBuffer::chainNextBlock[2] = {-1, -1};
 unsigned char StaticBuffer::blockAllocMap[DISK_BLOCKS];
+bool StaticBuffer::blockAllocMapDirty = false;
+uint64_t StaticBuffer::freeBlockBitmap[DISK_BLOCKS / 64];
+int StaticBuffer::nextFreeWord = 0;
+int StaticBuffer::blockToBuffer[DISK_BLOCKS];
+
+/*
+Allocates `capacity` buffer frames (clamped to [MIN_BUFFER_CAPACITY, DISK_BLOCKS]) as a single
+page aligned arena. With hugePages, the arena is taken from explicit huge pages
+(MAP_HUGETLB) if the system has them, and otherwise is 2 MB aligned and marked
+for transparent huge pages.
+With backgroundWrites, a background writer thread is started (see backgroundWriter()),
+and with readAhead > 0 a prefetch thread that reads that many blocks ahead (see readAhead()).
+*/
+StaticBuffer::StaticBuffer(int capacity, bool hugePages, int policyType, bool backgroundWrites,
+                           int readAhead) {
+  if (capacity < MIN_BUFFER_CAPACITY)
+    capacity = MIN_BUFFER_CAPACITY;
+  if (capacity > DISK_BLOCKS)
+    capacity = DISK_BLOCKS;
+  bufferCapacity = capacity;
+
+  arenaSize = (size_t)bufferCapacity * BLOCK_SIZE;
+  void *arena = nullptr;
+  arenaMapped = false;
+  if (hugePages) {
+    arenaSize = (arenaSize + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    arena = mmap(nullptr, arenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (arena != MAP_FAILED) {
+      arenaMapped = true;
+    } else {
+      arena = nullptr;
+      if (posix_memalign(&arena, HUGE_PAGE_SIZE, arenaSize) == 0) {
+        madvise(arena, arenaSize, MADV_HUGEPAGE);
+      } else {
+        arena = nullptr;
+      }
+    }
+  }
+  if (arena == nullptr && posix_memalign(&arena, 4096, arenaSize) != 0) {
+    std::cerr << "Unable to allocate " << bufferCapacity << " buffer frames" << std::endl;
+    exit(1);
+  }
+  blocks = (unsigned char (*)[BLOCK_SIZE])arena;
+  metainfo = new BufferMetaInfo[bufferCapacity];
 
-StaticBuffer::StaticBuffer() {
   for(int i=0;i<4;i++)
   {
     Disk::readBlock(&blockAllocMap[i*BLOCK_SIZE],i);
   }
+  // build the free block bitmap from the block allocation map
+  for (int word = 0; word < DISK_BLOCKS / 64; word++) {
+    freeBlockBitmap[word] = 0;
+  }
+  for (int blockNum = 0; blockNum < DISK_BLOCKS; blockNum++) {
+    if (blockAllocMap[blockNum] == UNUSED_BLK)
+      freeBlockBitmap[blockNum / 64] |= (uint64_t)1 << (blockNum % 64);
+  }
+  nextFreeWord = 0;
   // initialise all blocks as free
-  for (int bufferIndex = 0; bufferIndex<BUFFER_CAPACITY; bufferIndex++) {
+  for (int bufferIndex = 0; bufferIndex<bufferCapacity; bufferIndex++) {
     metainfo[bufferIndex].free = true;
     metainfo[bufferIndex].dirty = false;
-    metainfo[bufferIndex].timeStamp = -1;
     metainfo[bufferIndex].blockNum = -1;
+    metainfo[bufferIndex].pinCount = 0;
+    metainfo[bufferIndex].loading = false;
+    metainfo[bufferIndex].prefetched = false;
+  }
+  // handed out from the back, so that buffer 0 is used first
+  freeBuffers.clear();
+  for (int bufferIndex = bufferCapacity - 1; bufferIndex >= 0; bufferIndex--) {
+    freeBuffers.push_back(bufferIndex);
+  }
+  policy = ReplacementPolicy::create(policyType, bufferCapacity);
+  for (int blockNum = 0; blockNum < DISK_BLOCKS; blockNum++) {
+    blockToBuffer[blockNum] = E_BLOCKNOTINBUFFER;
+  }
+
+  writerStop = false;
+  writerRunning = backgroundWrites;
+  if (writerRunning) {
+    writerThread = std::thread(backgroundWriter);
+  }
+
+  for (int i = 0; i < 2; i++) {
+    chainLastBlock[i] = -1;
+    chainNextBlock[i] = -1;
+  }
+  prefetchStop = false;
+  prefetchStart = -1;
+  readAheadBlocks = readAhead > 0 ? readAhead : 0;
+  if (readAheadBlocks > 0) {
+    prefetchThread = std::thread(StaticBuffer::readAhead);
+  }
+}
+
+StaticBuffer::~StaticBuffer() {
+  if (readAheadBlocks > 0) {
+    {
+      std::lock_guard<std::mutex> guard(bufferLock);
+      prefetchStop = true;
+    }
+    prefetchWake.notify_one();
+    prefetchThread.join();
+    readAheadBlocks = 0;
+  }
+  if (writerRunning) {
+    {
+      std::lock_guard<std::mutex> guard(bufferLock);
+      writerStop = true;
+    }
+    writerWake.notify_one();
+    writerThread.join();
+    writerRunning = false;
+  }
+
+  flushAll();
+
+  if (arenaMapped)
+    munmap(blocks, arenaSize);
+  else
+    free(blocks);
+  delete[] metainfo;
+  delete policy;
+  freeBuffers.clear();
+  policy = nullptr;
+  blocks = nullptr;
+  metainfo = nullptr;
+  bufferCapacity = 0;
+}
+
+int StaticBuffer::getBufferCapacity() {
+  return bufferCapacity;
+}
+
+void StaticBuffer::getBufferStats(BufferStats *bufferStats) {
+  *bufferStats = stats;
+}
+
+void StaticBuffer::resetBufferStats() {
+  stats = {0, 0, 0, 0, 0, 0, 0};
+}
+
+/*
+Body of the background writer thread: every BACKGROUND_WRITER_INTERVAL_MS, or
+as soon as an eviction had to write a dirty buffer itself, writes the dirty
+buffers back so that the next evictions find clean victims.
+*/
+void StaticBuffer::backgroundWriter() {
+  std::unique_lock<std::mutex> lock(bufferLock);
+  while (!writerStop) {
+    writerWake.wait_for(lock, std::chrono::milliseconds(BACKGROUND_WRITER_INTERVAL_MS));
+    if (writerStop)
+      break;
+    lock.unlock();
+    writeDirtyBuffers();
+    lock.lock();
   }
 }
 
 /*
-At this stage, we are not writing back from the buffer to the disk since we are
-not modifying the buffer. So, we will define an empty destructor for now. In
-subsequent stages, we will implement the write-back functionality here.
+Writes the dirty, unpinned buffers back to the disk in increasing order of
+block number, BACKGROUND_WRITE_BATCH blocks per Disk::writeBlocks() call, and
+marks them clean. Runs on the background writer thread.
+Each batch is copied out of the buffers and written with bufferLock held, so
+that a buffer cannot be evicted (and its block written by getFreeBuffer())
+in the meantime. The main thread modifies a buffer before setDirtyBit(), so a
+buffer that changes while it is copied is dirty again afterwards and is
+written once more later.
 */
-StaticBuffer::~StaticBuffer() {
+int StaticBuffer::writeDirtyBuffers() {
+  std::vector<std::pair<int, int>> dirtyBuffers;  // (blockNum, bufferNum)
+  {
+    std::lock_guard<std::mutex> guard(bufferLock);
+    for (int bufferIndex = 0; bufferIndex < bufferCapacity; bufferIndex++) {
+      if (!metainfo[bufferIndex].free && metainfo[bufferIndex].dirty && metainfo[bufferIndex].pinCount == 0)
+        dirtyBuffers.push_back({metainfo[bufferIndex].blockNum, bufferIndex});
+    }
+  }
+  std::sort(dirtyBuffers.begin(), dirtyBuffers.end());
 
-  for(int i=0;i<4;i++)
+  static unsigned char batch[BACKGROUND_WRITE_BATCH][BLOCK_SIZE];
+  int blockNums[BACKGROUND_WRITE_BATCH];
+  int bufferNums[BACKGROUND_WRITE_BATCH];
+  for (size_t start = 0; start < dirtyBuffers.size(); start += BACKGROUND_WRITE_BATCH) {
+    std::lock_guard<std::mutex> guard(bufferLock);
+    int count = 0;
+    for (size_t i = start; i < dirtyBuffers.size() && i < start + BACKGROUND_WRITE_BATCH; i++) {
+      int blockNum = dirtyBuffers[i].first;
+      int bufferNum = dirtyBuffers[i].second;
+      // skip buffers that were written or reused since they were collected
+      if (metainfo[bufferNum].free || !metainfo[bufferNum].dirty || metainfo[bufferNum].blockNum != blockNum)
+        continue;
+      memcpy(batch[count], blocks[bufferNum], BLOCK_SIZE);
+      blockNums[count] = blockNum;
+      bufferNums[count] = bufferNum;
+      count++;
+    }
+    if (count == 0)
+      continue;
+
+    int ret = Disk::writeBlocks(&batch[0][0], blockNums, count);
+    if (ret != SUCCESS)
+      return ret;
+    for (int i = 0; i < count; i++) {
+      metainfo[bufferNums[i]].dirty = false;
+    }
+    stats.backgroundWrites += count;
+  }
+  return SUCCESS;
+}
+
+/*
+Writes the block allocation map and every dirty buffer back to the disk and
+commits them (Disk::flush()), so that they survive a crash from here on.
+The buffers stay in memory and are marked clean.
+*/
+int StaticBuffer::flushAll() {
+  std::lock_guard<std::mutex> guard(bufferLock);
+
+  if(blockAllocMapDirty)
   {
-    Disk::writeBlock(&blockAllocMap[i*BLOCK_SIZE],i);
+    for(int i=0;i<BLOCK_ALLOCATION_MAP_SIZE;i++)
+    {
+      Disk::writeBlock(&blockAllocMap[i*BLOCK_SIZE],i);
+    }
+    blockAllocMapDirty = false;
   }
 
-  for(int bufferIndex = 0; bufferIndex<BUFFER_CAPACITY; bufferIndex++)
+  for(int bufferIndex = 0; bufferIndex<bufferCapacity; bufferIndex++)
   {
     if(metainfo[bufferIndex].free == false && metainfo[bufferIndex].dirty == true)
     {
       Disk::writeBlock(blocks[bufferIndex],metainfo[bufferIndex].blockNum);
+      metainfo[bufferIndex].dirty = false;
     }
   }
 
+  // make sure everything written above has reached the disk
+  return Disk::flush();
 }
 
+/* Gets a buffer for a block that is not in the buffer (a new block, or one
+   that the caller is going to read into it). */
 int StaticBuffer::getFreeBuffer(int blockNum) {
   if (blockNum < 0 || blockNum >= DISK_BLOCKS) {
     return E_OUTOFBOUND;
   }
 
-  for(int i=0;i<BUFFER_CAPACITY;i++)
-  {
-    if(metainfo[i].free==false)
-    {
-        metainfo[i].timeStamp+=1;
-    }
-  }
-  int bufferNum;
-  int i;
-  for(i=0;i<BUFFER_CAPACITY;i++)
-  {
-    if(metainfo[i].free==true)
-    {
-        bufferNum = i;
-        break;
-    }
-  }
-  if(i == BUFFER_CAPACITY)
+  std::lock_guard<std::mutex> guard(bufferLock);
+  stats.misses++;
+  return allocateBuffer(blockNum);
+}
+
+/* Assigns a buffer to the block: a free buffer if there is one, else the
+   victim chosen by the replacement policy, which is written back first if
+   dirty. Called with bufferLock held. */
+int StaticBuffer::allocateBuffer(int blockNum) {
+  if(freeBuffers.empty())
   {
-    int max=0;
-    for(int j=0;j < BUFFER_CAPACITY;j++)
+    int victim = policy->pickVictim(metainfo);
+    if(victim < 0)
     {
-      if(metainfo[j].timeStamp > metainfo[max].timeStamp)
-      {
-        max = j;
-      }
+      return E_BUFFERFULL;
     }
-    if(metainfo[max].dirty == true)
-    {
-      Disk::writeBlock(blocks[max],metainfo[max].blockNum);
-    }
-    bufferNum = max;
+    evictBuffer(victim);
   }
+  int bufferNum = freeBuffers.back();
+  freeBuffers.pop_back();
 
+  blockToBuffer[blockNum] = bufferNum;
   metainfo[bufferNum].free = false;
   metainfo[bufferNum].dirty = false;
   metainfo[bufferNum].blockNum = blockNum;
-  metainfo[bufferNum].timeStamp = 0;
+  metainfo[bufferNum].pinCount = 0;
+  metainfo[bufferNum].loading = false;
+  metainfo[bufferNum].prefetched = false;
+  policy->onLoad(bufferNum, blockNum);
 
   return bufferNum;
 }
 
+/* Writes the block in the buffer back if it is dirty and frees the buffer.
+   Called with bufferLock held, on the main thread only. */
+void StaticBuffer::evictBuffer(int bufferNum) {
+  stats.evictions++;
+  if(metainfo[bufferNum].dirty == true)
+  {
+    stats.dirtyEvictions++;
+    Disk::writeBlock(blocks[bufferNum],metainfo[bufferNum].blockNum);
+    // the background writer is behind, wake it up
+    if (writerRunning)
+      writerWake.notify_one();
+  }
+  detachBuffer(bufferNum);
+}
+
+/* Removes the buffer from the block to buffer index and puts it back on the
+   free list. Called with bufferLock held. */
+void StaticBuffer::detachBuffer(int bufferNum) {
+  if (metainfo[bufferNum].blockNum != -1 && blockToBuffer[metainfo[bufferNum].blockNum] == bufferNum)
+  {
+    blockToBuffer[metainfo[bufferNum].blockNum] = E_BLOCKNOTINBUFFER;
+  }
+  metainfo[bufferNum].free = true;
+  metainfo[bufferNum].dirty = false;
+  metainfo[bufferNum].blockNum = -1;
+  metainfo[bufferNum].pinCount = 0;
+  metainfo[bufferNum].prefetched = false;
+  freeBuffers.push_back(bufferNum);
+  policy->onRelease(bufferNum);
+}
+
 /* Get the buffer index where a particular block is stored
    or E_BLOCKNOTINBUFFER otherwise
 */
@@ -99,16 +362,203 @@ int StaticBuffer::getBufferNum(int blockNum) {
       return E_OUTOFBOUND;
     }
 
-  // find and return the bufferIndex which corresponds to blockNum (check metainfo)
-  for (int bufferIndex = 0; bufferIndex<BUFFER_CAPACITY; bufferIndex++)
+  // look up the bufferIndex which corresponds to blockNum
+  // (E_BLOCKNOTINBUFFER if the block is not in the buffer)
+  return blockToBuffer[blockNum];
+}
+
+/* Returns the buffer holding the block, reading the block into a buffer
+   first if it is not in the buffer (waiting for it if the prefetch thread
+   is reading it). Also tells the replacement policy of the access and starts
+   the read-ahead of a sequential scan. */
+int StaticBuffer::loadBlock(int blockNum) {
+  if (blockNum < 0 || blockNum >= DISK_BLOCKS) {
+    return E_OUTOFBOUND;
+  }
+
+  std::unique_lock<std::mutex> lock(bufferLock);
+  int bufferNum = blockToBuffer[blockNum];
+  while (bufferNum != E_BLOCKNOTINBUFFER && metainfo[bufferNum].loading) {
+    loadDone.wait(lock);
+    bufferNum = blockToBuffer[blockNum];
+  }
+
+  if (bufferNum != E_BLOCKNOTINBUFFER) {
+    stats.hits++;
+    if (metainfo[bufferNum].prefetched) {
+      stats.prefetchHits++;
+      metainfo[bufferNum].prefetched = false;
+    }
+    policy->onHit(bufferNum);
+  } else {
+    stats.misses++;
+    bufferNum = allocateBuffer(blockNum);
+    if (bufferNum < 0) {
+      return bufferNum;
+    }
+    metainfo[bufferNum].loading = true;
+    lock.unlock();
+    Disk::readBlock(blocks[bufferNum], blockNum);
+    lock.lock();
+    metainfo[bufferNum].loading = false;
+    loadDone.notify_all();
+  }
+
+  if (readAheadBlocks > 0) {
+    noteChainAccess(bufferNum, blockNum);
+  }
+  return bufferNum;
+}
+
+/* Marks the buffer as free and removes it from the block to buffer index
+   (the contents of the buffer are discarded, even if dirty)
+*/
+void StaticBuffer::releaseBuffer(int bufferNum) {
+  std::unique_lock<std::mutex> lock(bufferLock);
+  if (bufferNum < 0 || bufferNum >= bufferCapacity || metainfo[bufferNum].free)
   {
-    if(metainfo[bufferIndex].blockNum == blockNum)
-        return bufferIndex;
+    return;
   }
+  while (metainfo[bufferNum].loading) {
+    loadDone.wait(lock);
+  }
+  detachBuffer(bufferNum);
+}
+
+/*
+Detects a sequential walk over a chain of record blocks or index leaves: the
+block accessed is the rblock of the block of the same type accessed before it.
+If the next block is not in the buffer, frees enough buffers for the
+read-ahead (evicting them here, on the main thread) and asks the prefetch
+thread to read the chain from the rblock of this block on.
+Called with bufferLock held.
+*/
+void StaticBuffer::noteChainAccess(int bufferNum, int blockNum) {
+  struct HeadInfo *head = (struct HeadInfo *)blocks[bufferNum];
+  int chain;
+  if (head->blockType == REC)
+    chain = 0;
+  else if (head->blockType == IND_LEAF)
+    chain = 1;
+  else
+    return;
+
+  if (blockNum == chainLastBlock[chain])
+    return;
+  bool sequential = (blockNum == chainNextBlock[chain]);
+  chainLastBlock[chain] = blockNum;
+  chainNextBlock[chain] = head->rblock;
+  if (!sequential || head->rblock < 0 || head->rblock >= DISK_BLOCKS)
+    return;
+  // the prefetch thread is still ahead of the scan: wake it only once the scan
+  // catches up, so that it is woken once per readAheadBlocks blocks
+  if (blockToBuffer[head->rblock] != E_BLOCKNOTINBUFFER)
+    return;
+
+  // keep this block while making room for the blocks after it
+  int reserve = readAheadBlocks < bufferCapacity / 4 ? readAheadBlocks : bufferCapacity / 4;
+  metainfo[bufferNum].pinCount++;
+  while ((int)freeBuffers.size() < reserve) {
+    int victim = policy->pickVictim(metainfo);
+    if (victim < 0)
+      break;
+    evictBuffer(victim);
+  }
+  metainfo[bufferNum].pinCount--;
+
+  prefetchStart = head->rblock;
+  prefetchType = head->blockType;
+  prefetchWake.notify_one();
+}
+
+/*
+Body of the prefetch thread: follows the chain from prefetchStart for up to
+readAheadBlocks blocks, reading the blocks that are not in the buffer into
+free buffers. It stops early at a block of another type or when it runs out
+of free buffers, and starts over when a newer request comes in. It never
+evicts a buffer, so the main thread's buffer pointers stay valid.
+*/
+void StaticBuffer::readAhead() {
+  std::unique_lock<std::mutex> lock(bufferLock);
+  while (true) {
+    prefetchWake.wait(lock, [] { return prefetchStop || prefetchStart != -1; });
+    if (prefetchStop)
+      break;
+
+    int blockNum = prefetchStart;
+    int blockType = prefetchType;
+    prefetchStart = -1;
+    for (int i = 0; i < readAheadBlocks && prefetchStart == -1 && !prefetchStop; i++) {
+      if (blockNum < 0 || blockNum >= DISK_BLOCKS || blockAllocMap[blockNum] != blockType)
+        break;
+
+      int bufferNum = blockToBuffer[blockNum];
+      if (bufferNum == E_BLOCKNOTINBUFFER) {
+        if (freeBuffers.empty())
+          break;
+        bufferNum = allocateBuffer(blockNum);
+        metainfo[bufferNum].loading = true;
+        metainfo[bufferNum].prefetched = true;
+        metainfo[bufferNum].pinCount = 1;
+        stats.prefetches++;
+        lock.unlock();
+        Disk::readBlock(blocks[bufferNum], blockNum);
+        lock.lock();
+        metainfo[bufferNum].loading = false;
+        metainfo[bufferNum].pinCount--;
+        loadDone.notify_all();
+      } else if (metainfo[bufferNum].loading) {
+        break;
+      }
+      blockNum = ((struct HeadInfo *)blocks[bufferNum])->rblock;
+    }
+  }
+}
+
+/* Keeps the buffer from being chosen as a victim until it is unpinned as many times */
+void StaticBuffer::pinBuffer(int bufferNum) {
+  std::lock_guard<std::mutex> guard(bufferLock);
+  metainfo[bufferNum].pinCount++;
+}
+
+/* Drops one pin of the buffer, if it still holds the block it was pinned for */
+void StaticBuffer::unpinBuffer(int bufferNum, int blockNum) {
+  std::lock_guard<std::mutex> guard(bufferLock);
+  if (bufferNum < 0 || bufferNum >= bufferCapacity || metainfo[bufferNum].blockNum != blockNum)
+  {
+    return;
+  }
+  if (metainfo[bufferNum].pinCount > 0)
+  {
+    metainfo[bufferNum].pinCount--;
+  }
+}
 
+/* Returns a free disk block, or E_DISKFULL if there is none. The search goes
+   64 blocks at a time through freeBlockBitmap, starting where the previous
+   allocation left off, so that the full part of the disk is not rescanned
+   on every allocation. */
+int StaticBuffer::findFreeBlock() {
+  const int numWords = DISK_BLOCKS / 64;
+  for (int i = 0; i < numWords; i++) {
+    int word = (nextFreeWord + i) % numWords;
+    if (freeBlockBitmap[word] != 0) {
+      nextFreeWord = word;
+      return word * 64 + __builtin_ctzll(freeBlockBitmap[word]);
+    }
+  }
+  return E_DISKFULL;
+}
 
-  // if block is not in the buffer
-  return E_BLOCKNOTINBUFFER;
+/* Sets the type of the block in the block allocation map (UNUSED_BLK to free it),
+   keeping the free block bitmap in sync */
+void StaticBuffer::setBlockAllocType(int blockNum, int blockType) {
+  blockAllocMap[blockNum] = (unsigned char)blockType;
+  blockAllocMapDirty = true;
+  if (blockType == UNUSED_BLK)
+    freeBlockBitmap[blockNum / 64] |= (uint64_t)1 << (blockNum % 64);
+  else
+    freeBlockBitmap[blockNum / 64] &= ~((uint64_t)1 << (blockNum % 64));
 }
 
 int StaticBuffer::setDirtyBit(int blockNum){
@@ -122,6 +572,7 @@ int StaticBuffer::setDirtyBit(int blockNum){
       return bufferIndex;
     // if blockNum is out of bound (bufferNum = E_OUTOFBOUND)
     //     return E_OUTOFBOUND
+    std::lock_guard<std::mutex> guard(bufferLock);
     metainfo[bufferIndex].dirty = true;
     return SUCCESS;
     // else
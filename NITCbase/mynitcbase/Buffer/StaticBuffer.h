@@ -1,14 +1,34 @@
 #ifndef NITCBASE_STATICBUFFER_H
 #define NITCBASE_STATICBUFFER_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "../Disk_Class/Disk.h"
 #include "../define/constants.h"
+#include "ReplacementPolicy.h"
 
 struct BufferMetaInfo {
   bool free;
   bool dirty;
   int blockNum;
-  int timeStamp;
+  int pinCount;  // number of pins held on the frame; a pinned frame is never evicted
+  bool loading;     // the block is still being read into the frame
+  bool prefetched;  // the block was read ahead and has not been accessed yet
+};
+
+/* counters of the buffer pool (see StaticBuffer::getBufferStats()) */
+struct BufferStats {
+  int64_t hits;            // block found in the buffer
+  int64_t misses;          // a frame had to be found for the block
+  int64_t evictions;       // ... and it was taken from another block
+  int64_t dirtyEvictions;  // ... which had to be written back first
+  int64_t backgroundWrites;  // dirty buffers written back by the background writer
+  int64_t prefetches;        // blocks read ahead of a sequential scan
+  int64_t prefetchHits;      // ... that the scan found in the buffer
 };
 
 class StaticBuffer {
@@ -16,19 +36,75 @@ class StaticBuffer {
 
  private:
   // fields
-  static unsigned char blocks[BUFFER_CAPACITY][BLOCK_SIZE];
-  static struct BufferMetaInfo metainfo[BUFFER_CAPACITY];
+  // the buffer frames: one aligned arena of bufferCapacity blocks
+  static unsigned char (*blocks)[BLOCK_SIZE];
+  static struct BufferMetaInfo *metainfo;
+  static int bufferCapacity;
+  static size_t arenaSize;
+  static bool arenaMapped;
   static unsigned char blockAllocMap[DISK_BLOCKS];
+  static bool blockAllocMapDirty;
+  // one bit per disk block, set if the block is free in blockAllocMap, and the
+  // word of the bitmap the next allocation starts searching from (next fit)
+  static uint64_t freeBlockBitmap[DISK_BLOCKS / 64];
+  static int nextFreeWord;
+  // buffer index holding each disk block (or E_BLOCKNOTINBUFFER), kept in sync with metainfo
+  static int blockToBuffer[DISK_BLOCKS];
+  // frames not holding any block, and the policy choosing victims among the rest
+  static std::vector<int> freeBuffers;
+  static ReplacementPolicy *policy;
+  static BufferStats stats;
+
+  // background writer: writes dirty buffers back ahead of their eviction.
+  // bufferLock guards the free, dirty and blockNum fields of metainfo against it.
+  static std::mutex bufferLock;
+  static std::condition_variable writerWake;
+  static std::thread writerThread;
+  static bool writerRunning;
+  static bool writerStop;
+
+  // read-ahead: when a record block or index leaf is reached through the rblock
+  // of the previous one, a prefetch thread reads the next readAheadBlocks blocks
+  // of the chain into free buffers. Only the main thread ever evicts a buffer.
+  static int readAheadBlocks;
+  static std::condition_variable loadDone;
+  static std::condition_variable prefetchWake;
+  static std::thread prefetchThread;
+  static bool prefetchStop;
+  static int prefetchStart;
+  static int prefetchType;
+  // last block of each chain type (REC, IND_LEAF) accessed, and its rblock
+  static int chainLastBlock[2];
+  static int chainNextBlock[2];
 
   // methods
   static int getFreeBuffer(int blockNum);
   static int getBufferNum(int blockNum);
+  static int loadBlock(int blockNum);
+  static void releaseBuffer(int bufferNum);
+  static int allocateBuffer(int blockNum);
+  static void evictBuffer(int bufferNum);
+  static void detachBuffer(int bufferNum);
+  static void noteChainAccess(int bufferNum, int blockNum);
+  static void readAhead();
+  static void pinBuffer(int bufferNum);
+  static void unpinBuffer(int bufferNum, int blockNum);
+  static void backgroundWriter();
+  static int writeDirtyBuffers();
+  static int findFreeBlock();
+  static void setBlockAllocType(int blockNum, int blockType);
 
  public:
   // methods
   static int getStaticBlockType(int blockNum);
   static int setDirtyBit(int blockNum);
-  StaticBuffer();
+  static int flushAll();
+  static int getBufferCapacity();
+  static void getBufferStats(BufferStats *bufferStats);
+  static void resetBufferStats();
+  StaticBuffer(int capacity = BUFFER_CAPACITY, bool hugePages = false,
+               int policyType = BUFFER_POLICY_CLOCK, bool backgroundWrites = true,
+               int readAhead = READ_AHEAD_BLOCKS);
   ~StaticBuffer();
 };
 
@@ -29,6 +29,8 @@ OpenRelTable::OpenRelTable() {
   RelCacheTable::recordToRelCatEntry(relCatRecord, &relCacheEntry.relCatEntry);
   relCacheEntry.recId.block = RELCAT_BLOCK;
   relCacheEntry.recId.slot = RELCAT_SLOTNUM_FOR_RELCAT;
+  relCacheEntry.dirty = false;
+  RelCacheTable::buildFreeSpaceMap(&relCacheEntry);
 
   // allocate this on the heap because we want it to persist outside this function
   RelCacheTable::relCache[RELCAT_RELID] = (struct RelCacheEntry*)malloc(sizeof(RelCacheEntry));
@@ -42,6 +44,7 @@ OpenRelTable::OpenRelTable() {
   RelCacheTable::recordToRelCatEntry(relCatRecord,&relCacheEntry.relCatEntry);
   relCacheEntry.recId.block=RELCAT_BLOCK;
   relCacheEntry.recId.slot=RELCAT_SLOTNUM_FOR_ATTRCAT;
+  RelCacheTable::buildFreeSpaceMap(&relCacheEntry);
 
   // set the value at RelCacheTable::relCache[ATTRCAT_RELID]
   RelCacheTable::relCache[ATTRCAT_RELID] = (struct RelCacheEntry*)malloc(sizeof(RelCacheEntry));
@@ -72,6 +75,7 @@ OpenRelTable::OpenRelTable() {
     AttrCacheTable::recordToAttrCatEntry(attrCatRecord,&(attrCacheEntry->attrCatEntry));
     attrCacheEntry->recId.block=ATTRCAT_BLOCK;
     attrCacheEntry->recId.slot=i;
+    attrCacheEntry->dirty=false;
     attrCacheEntry->next=nullptr;
     if(head==nullptr)
       head=attrCacheEntry;
@@ -97,6 +101,7 @@ OpenRelTable::OpenRelTable() {
     AttrCacheTable::recordToAttrCatEntry(attrCatRecord,&(attrCacheEntry->attrCatEntry));
     attrCacheEntry->recId.block=ATTRCAT_BLOCK;
     attrCacheEntry->recId.slot=i;
+    attrCacheEntry->dirty=false;
     attrCacheEntry->next=nullptr;
     if(head==nullptr)
       head=attrCacheEntry;
@@ -189,7 +194,8 @@ int OpenRelTable::openRel(char relName[ATTR_SIZE]) {
   struct RelCacheEntry relCacheEntry;
   RelCacheTable::recordToRelCatEntry(relCatRecord, &relCacheEntry.relCatEntry);
   relCacheEntry.recId = relcatRecId;
-  // relCacheEntry.dirty = true;
+  relCacheEntry.dirty = false;
+  RelCacheTable::buildFreeSpaceMap(&relCacheEntry);
   RelCacheTable::relCache[relId] = (struct RelCacheEntry*)malloc(sizeof(RelCacheEntry));
   *(RelCacheTable::relCache[relId]) = relCacheEntry;
 
@@ -222,7 +228,7 @@ int OpenRelTable::openRel(char relName[ATTR_SIZE]) {
       AttrCacheTable::recordToAttrCatEntry(attrCatRecord,&(attrCacheEntry->attrCatEntry));
       attrCacheEntry->recId.block=attrcatRecId.block;
       attrCacheEntry->recId.slot=attrcatRecId.slot;
-      // attrCacheEntry->dirty = true;
+      attrCacheEntry->dirty = false;
       attrCacheEntry->next=nullptr;
       if(listHead == nullptr)
       {
@@ -268,17 +274,8 @@ int OpenRelTable::closeRel(int relId) {
     return E_RELNOTOPEN;
   }
 
-  if(RelCacheTable::relCache[relId]->dirty == true)
-  {
-    RelCatEntry relCatEntry = RelCacheTable::relCache[relId]->relCatEntry;
-    Attribute record[RELCAT_NO_ATTRS];
-    RelCacheTable::relCatEntryToRecord(&relCatEntry,record);
-    char str[ATTR_SIZE] = RELCAT_ATTR_RELNAME;
-    RelCacheTable::resetSearchIndex(RELCAT_RELID);
-    RecId recId = BlockAccess::linearSearch(RELCAT_RELID,str,record[RELCAT_REL_NAME_INDEX],EQ);
-    RecBuffer relCatBlock(recId.block);
-    relCatBlock.setRecord(record,recId.slot);
-  }
+  // write back the dirty relation and attribute cache entries of the relation
+  writeBackEntries(relId);
 
   // free the memory allocated in the relation and attribute caches which was
   // allocated in the OpenRelTable::openRel() function
@@ -289,14 +286,6 @@ int OpenRelTable::closeRel(int relId) {
   AttrCacheEntry* next=nullptr;
   for(AttrCacheEntry* attrCacheEntry= AttrCacheTable::attrCache[relId];attrCacheEntry!=nullptr;attrCacheEntry=next)
   {
-      if(attrCacheEntry->dirty == true)
-      {
-        AttrCatEntry attrCatEntry = attrCacheEntry->attrCatEntry;
-        Attribute record[ATTRCAT_NO_ATTRS];
-        AttrCacheTable::attrCatEntryToRecord(&attrCatEntry,record);
-        RecBuffer attrCatBlock(attrCacheEntry->recId.block);
-        attrCatBlock.setRecord(record, attrCacheEntry->recId.slot);
-      }
       next=attrCacheEntry->next;
       delete(attrCacheEntry);
       attrCacheEntry = nullptr;
@@ -311,6 +300,51 @@ int OpenRelTable::closeRel(int relId) {
 }
 
 
+/*
+Writes the dirty relation cache entry and attribute cache entries of the open
+relation relId back to the relation and attribute catalogs (through the buffer)
+and marks them clean. The entries stay in the cache.
+*/
+void OpenRelTable::writeBackEntries(int relId) {
+  if(RelCacheTable::relCache[relId]->dirty == true)
+  {
+    RelCatEntry relCatEntry = RelCacheTable::relCache[relId]->relCatEntry;
+    Attribute record[RELCAT_NO_ATTRS];
+    RelCacheTable::relCatEntryToRecord(&relCatEntry,record);
+    RecId recId = RelCacheTable::relCache[relId]->recId;
+    RecBuffer relCatBlock(recId.block);
+    relCatBlock.setRecord(record,recId.slot);
+    RelCacheTable::relCache[relId]->dirty = false;
+  }
+
+  for(AttrCacheEntry* attrCacheEntry= AttrCacheTable::attrCache[relId];attrCacheEntry!=nullptr;attrCacheEntry=attrCacheEntry->next)
+  {
+      if(attrCacheEntry->dirty == true)
+      {
+        AttrCatEntry attrCatEntry = attrCacheEntry->attrCatEntry;
+        Attribute record[ATTRCAT_NO_ATTRS];
+        AttrCacheTable::attrCatEntryToRecord(&attrCatEntry,record);
+        RecBuffer attrCatBlock(attrCacheEntry->recId.block);
+        attrCatBlock.setRecord(record, attrCacheEntry->recId.slot);
+        attrCacheEntry->dirty = false;
+      }
+  }
+}
+
+/*
+Writes back the dirty cache entries of every open relation (including the
+relation and attribute catalogs) so that the catalogs on disk describe the
+blocks written by the next StaticBuffer::flushAll().
+*/
+int OpenRelTable::writeBackCache() {
+  for(int relId = 0; relId < MAX_OPEN; relId++)
+  {
+    if(tableMetaInfo[relId].free == false)
+      writeBackEntries(relId);
+  }
+  return SUCCESS;
+}
+
 int OpenRelTable::getFreeOpenRelTableEntry() {
 
   /* traverse through the tableMetaInfo array,
@@ -21,6 +21,7 @@ class OpenRelTable {
   static int getRelId(char relName[ATTR_SIZE]);
   static int openRel(char relName[ATTR_SIZE]);
   static int closeRel(int relId);
+  static int writeBackCache();
 
  private:
   // field
@@ -28,6 +29,7 @@ class OpenRelTable {
 
   // method
   static int getFreeOpenRelTableEntry();
+  static void writeBackEntries(int relId);
 };
 
 #endif  // NITCBASE_OPENRELTABLE_H
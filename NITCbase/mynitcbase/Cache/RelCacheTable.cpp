@@ -36,17 +36,8 @@ void RelCacheTable::recordToRelCatEntry(union Attribute record[RELCAT_NO_ATTRS],
   relCatEntry->firstBlk = (int)record[RELCAT_FIRST_BLOCK_INDEX].nVal;
   relCatEntry->lastBlk = (int)record[RELCAT_LAST_BLOCK_INDEX].nVal;
   relCatEntry->numSlotsPerBlk = (int)record[RELCAT_NO_SLOTS_PER_BLOCK_INDEX].nVal;
-  int block=relCatEntry->firstBlk;
-  int count=0;
-  while(block!=-1)
-  {
-    RecBuffer recBuffer(block);
-    HeadInfo header;
-    recBuffer.getHeader(&header);
-    count++;
-    block=header.rblock;
-  }
-relCatEntry->numBlks=count;
+  // numBlks is counted by buildFreeSpaceMap() while it walks the block chain
+  relCatEntry->numBlks = 0;
   /* fill the rest of the relCatEntry struct with the values at
       RELCAT_NO_RECORDS_INDEX,
       RELCAT_FIRST_BLOCK_INDEX,
@@ -66,6 +57,88 @@ void RelCacheTable::relCatEntryToRecord(RelCatEntry* relCatEntry,union Attribute
 }
 
 
+/* Walks the record blocks of the relation once, marking the blocks that have a
+free slot in the free-space map of the entry and counting the blocks.
+Only the headers are read: a block has a free slot iff numEntries < numSlots.
+NOTE: relCacheEntry->relCatEntry must already be filled in
+*/
+void RelCacheTable::buildFreeSpaceMap(RelCacheEntry *relCacheEntry) {
+  memset(relCacheEntry->freeSpaceMap, 0, sizeof(relCacheEntry->freeSpaceMap));
+  relCacheEntry->numFreeBlocks = 0;
+
+  int count = 0;
+  int block = relCacheEntry->relCatEntry.firstBlk;
+  while (block != -1) {
+    RecBuffer recBuffer(block);
+    HeadInfo header;
+    recBuffer.getHeader(&header);
+    if (header.numEntries < header.numSlots) {
+      relCacheEntry->freeSpaceMap[block / 64] |= (uint64_t)1 << (block % 64);
+      relCacheEntry->numFreeBlocks++;
+    }
+    count++;
+    block = header.rblock;
+  }
+  relCacheEntry->relCatEntry.numBlks = count;
+}
+
+/* Returns a record block of the relation with a free slot, or -1 if every block
+is full. The last block is tried first so that appends do not touch the map.
+*/
+int RelCacheTable::getBlockWithFreeSlot(int relId) {
+  if (relId < 0 || relId >= MAX_OPEN) {
+    return E_OUTOFBOUND;
+  }
+
+  if (relCache[relId] == nullptr) {
+    return E_RELNOTOPEN;
+  }
+
+  RelCacheEntry *entry = relCache[relId];
+  if (entry->numFreeBlocks == 0) {
+    return -1;
+  }
+
+  int lastBlk = entry->relCatEntry.lastBlk;
+  if (lastBlk != -1 && (entry->freeSpaceMap[lastBlk / 64] >> (lastBlk % 64) & 1)) {
+    return lastBlk;
+  }
+
+  for (int word = 0; word < DISK_BLOCKS / 64; word++) {
+    if (entry->freeSpaceMap[word] != 0) {
+      return word * 64 + __builtin_ctzll(entry->freeSpaceMap[word]);
+    }
+  }
+  return -1;
+}
+
+/* Records in the free-space map whether block `blockNum` of the relation has a
+free slot. Called whenever a slot of the block is taken or freed, and with
+hasFreeSlot = false when the block is released.
+*/
+int RelCacheTable::setFreeSpace(int relId, int blockNum, bool hasFreeSlot) {
+  if (relId < 0 || relId >= MAX_OPEN || blockNum < 0 || blockNum >= DISK_BLOCKS) {
+    return E_OUTOFBOUND;
+  }
+
+  if (relCache[relId] == nullptr) {
+    return E_RELNOTOPEN;
+  }
+
+  RelCacheEntry *entry = relCache[relId];
+  uint64_t bit = (uint64_t)1 << (blockNum % 64);
+  bool wasFree = (entry->freeSpaceMap[blockNum / 64] & bit) != 0;
+  if (hasFreeSlot && !wasFree) {
+    entry->freeSpaceMap[blockNum / 64] |= bit;
+    entry->numFreeBlocks++;
+  } else if (!hasFreeSlot && wasFree) {
+    entry->freeSpaceMap[blockNum / 64] &= ~bit;
+    entry->numFreeBlocks--;
+  }
+
+  return SUCCESS;
+}
+
 /* will return the searchIndex for the relation corresponding to `relId
 NOTE: this function expects the caller to allocate memory for `*searchIndex`
 */
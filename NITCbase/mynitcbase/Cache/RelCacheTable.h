@@ -1,6 +1,8 @@
 #ifndef NITCBASE_RELCACHETABLE_H
 #define NITCBASE_RELCACHETABLE_H
 
+#include <cstdint>
+
 #include "../Buffer/BlockBuffer.h"
 #include "../define/constants.h"
 #include "../define/id.h"
@@ -21,6 +23,11 @@ typedef struct RelCacheEntry {
   bool dirty;
   RecId recId;
   RecId searchIndex;
+  // free-space map: bit i is set if record block i of the relation has a free
+  // slot. Rebuilt from the block headers (numEntries < numSlots) when the
+  // relation is opened and kept up to date by inserts and deletes.
+  uint64_t freeSpaceMap[DISK_BLOCKS / 64];
+  int numFreeBlocks;
 
 } RelCacheEntry;
 
@@ -34,6 +41,8 @@ class RelCacheTable {
   static int getSearchIndex(int relId, RecId *searchIndex);
   static int setSearchIndex(int relId, RecId *searchIndex);
   static int resetSearchIndex(int relId);
+  static int getBlockWithFreeSlot(int relId);
+  static int setFreeSpace(int relId, int blockNum, bool hasFreeSlot);
 
  private:
   // field
@@ -42,5 +51,6 @@ class RelCacheTable {
   // methods
   static void recordToRelCatEntry(union Attribute record[RELCAT_NO_ATTRS], RelCatEntry *relCatEntry);
   static void relCatEntryToRecord(RelCatEntry *relCatEntry, union Attribute record[RELCAT_NO_ATTRS]);
+  static void buildFreeSpaceMap(RelCacheEntry *relCacheEntry);
 };
 #endif  // NITCBASE_RELCACHETABLE_H
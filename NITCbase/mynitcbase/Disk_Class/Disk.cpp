@@ -1,39 +1,240 @@
 #include "Disk.h"
 
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 
-#include "../define/constants.h"
+int Disk::fd = -1;
+int Disk::mode = DISK_MODE_PREAD;
+unsigned char *Disk::map = nullptr;
+int Disk::walFd = -1;
+int64_t Disk::walEnd = 0;
+int64_t Disk::walCommitEnd = 0;
+int64_t Disk::walOffset[DISK_BLOCKS];
+std::mutex Disk::walLock;
+std::atomic<int64_t> Disk::numReads(0);
+std::atomic<int64_t> Disk::numWrites(0);
+std::atomic<int64_t> Disk::numBytesRead(0);
+std::atomic<int64_t> Disk::numBytesWritten(0);
+std::atomic<int64_t> Disk::numCommits(0);
+std::atomic<int64_t> Disk::numCheckpoints(0);
+
+#define WAL_MAGIC 0x4e424c47  // "NBLG"
+
+// pread()/pwrite() the whole range, retrying on short transfers and EINTR
+static int preadFull(int fd, void *buf, size_t len, off_t offset) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t ret = pread(fd, (unsigned char *)buf + done, len - done, offset + done);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return FAILURE;
+    }
+    done += ret;
+  }
+  return SUCCESS;
+}
+
+static int pwriteFull(int fd, const void *buf, size_t len, off_t offset) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t ret = pwrite(fd, (const unsigned char *)buf + done, len - done, offset + done);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return FAILURE;
+    }
+    done += ret;
+  }
+  return SUCCESS;
+}
+
+// pwritev() all of iov, retrying on short transfers and EINTR (iov is consumed)
+static int pwritevFull(int fd, struct iovec *iov, int iovcnt, off_t offset) {
+  while (iovcnt > 0) {
+    ssize_t ret = pwritev(fd, iov, iovcnt, offset);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return FAILURE;
+    }
+    offset += ret;
+    while (iovcnt > 0 && (size_t)ret >= iov->iov_len) {
+      ret -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (unsigned char *)iov->iov_base + ret;
+      iov->iov_len -= ret;
+    }
+  }
+  return SUCCESS;
+}
+
+// FNV-1a over the record header (with checksum = 0) and the block contents
+static uint32_t walChecksum(WalRecordHeader header, const unsigned char *block) {
+  header.checksum = 0;
+  uint32_t hash = 2166136261u;
+  const unsigned char *bytes = (const unsigned char *)&header;
+  for (size_t i = 0; i < sizeof(header); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  if (block != nullptr) {
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+      hash = (hash ^ block[i]) * 16777619u;
+    }
+  }
+  return hash;
+}
 
 /*
- * Used to make a temporary copy of the disk contents before the starting of a new session.
- * This ensures that if the system has a forced shutdown during the course of the session,
- * the previous state of the disk is not lost.
+ * Opens the disk file for the whole session and replays the write-ahead log
+ * left behind by a session that did not shut down cleanly.
+ * The disk file is updated in place: changed blocks are first appended to the
+ * log, made durable by flush(), and copied into the disk file by checkpoint().
+ * In DISK_MODE_MMAP the whole disk file is also mapped into memory; if the
+ * mapping fails we fall back to DISK_MODE_PREAD.
  */
-Disk::Disk() {
-  /* An efficient method to copy files */
-  /* Copy Disk to Disk Run Copy */
-  std::ifstream src(DISK_PATH, std::ios::binary);
-  std::ofstream dst(DISK_RUN_COPY_PATH, std::ios::binary);
+Disk::Disk(int diskMode) {
+  for (int i = 0; i < DISK_BLOCKS; i++) {
+    walOffset[i] = -1;
+  }
 
-  dst << src.rdbuf();
-  src.close();
-  dst.close();
+  fd = open(DISK_PATH, O_RDWR);
+  if (fd < 0) {
+    std::cerr << "Unable to open " << DISK_PATH << std::endl;
+  }
+
+  mode = DISK_MODE_PREAD;
+  if (diskMode == DISK_MODE_MMAP && fd >= 0) {
+    void *addr = mmap(nullptr, DISK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      std::cerr << "mmap of " << DISK_PATH << " failed, using pread/pwrite" << std::endl;
+    } else {
+      map = (unsigned char *)addr;
+      mode = DISK_MODE_MMAP;
+    }
+  }
+
+  walFd = open(DISK_WAL_PATH, O_RDWR | O_CREAT, 0644);
+  if (walFd < 0) {
+    std::cerr << "Unable to open " << DISK_WAL_PATH << std::endl;
+    return;
+  }
+  recover();
 }
 
 /*
- * Used to update the changes made to the disk on graceful termination of the latest session.
- * This ensures that these changes are visible in future sessions.
+ * Commits and checkpoints whatever is left in the log so that the disk file is
+ * complete and the log is empty on graceful termination of the session.
  */
 Disk::~Disk() {
-  /* An efficient method to copy files */
-  /* Copy Disk Run Copy to Disk */
-  std::ifstream src(DISK_RUN_COPY_PATH, std::ios::binary);
-  std::ofstream dst(DISK_PATH, std::ios::binary);
+  if (walFd >= 0) {
+    flush();
+    checkpoint();
+    close(walFd);
+    walFd = -1;
+  }
+
+  if (map != nullptr) {
+    munmap(map, DISK_SIZE);
+    map = nullptr;
+  }
+  mode = DISK_MODE_PREAD;
+
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+}
+
+/*
+ * Redo recovery: applies, in log order, the block after-images of every record
+ * that is followed by a commit record. Records after the last commit record
+ * (or after the first torn/corrupt record) are discarded.
+ */
+int Disk::recover() {
+  int64_t offset = 0;
+  int64_t committedUpTo = 0;
+  WalRecordHeader header;
+  unsigned char block[BLOCK_SIZE];
+
+  // first pass: find the end of the last commit record
+  while (preadFull(walFd, &header, sizeof(header), offset) == SUCCESS && header.magic == WAL_MAGIC) {
+    if (header.type == WAL_COMMIT) {
+      if (walChecksum(header, nullptr) != header.checksum) {
+        break;
+      }
+      offset += sizeof(header);
+      committedUpTo = offset;
+    } else if (header.type == WAL_BLOCK && header.blockNum >= 0 && header.blockNum < DISK_BLOCKS) {
+      if (preadFull(walFd, block, BLOCK_SIZE, offset + sizeof(header)) != SUCCESS ||
+          walChecksum(header, block) != header.checksum) {
+        break;
+      }
+      offset += sizeof(header) + BLOCK_SIZE;
+    } else {
+      break;
+    }
+  }
+
+  // second pass: redo the committed after-images
+  int applied = 0;
+  offset = 0;
+  while (offset < committedUpTo) {
+    preadFull(walFd, &header, sizeof(header), offset);
+    offset += sizeof(header);
+    if (header.type == WAL_BLOCK) {
+      preadFull(walFd, block, BLOCK_SIZE, offset);
+      offset += BLOCK_SIZE;
+      writeToDataFile(block, header.blockNum);
+      applied++;
+    }
+  }
+
+  if (applied > 0) {
+    std::cerr << "Recovered " << applied << " block(s) from " << DISK_WAL_PATH << std::endl;
+    if (mode == DISK_MODE_MMAP) {
+      msync(map, DISK_SIZE, MS_SYNC);
+    } else {
+      fdatasync(fd);
+    }
+  }
 
-  dst << src.rdbuf();
-  src.close();
-  dst.close();
+  walEnd = 0;
+  walCommitEnd = 0;
+  if (ftruncate(walFd, 0) != 0) {
+    return FAILURE;
+  }
+  return SUCCESS;
+}
+
+int Disk::readFromDataFile(unsigned char *block, int blockNum) {
+  const off_t offset = (off_t)blockNum * BLOCK_SIZE;
+  if (mode == DISK_MODE_MMAP) {
+    memcpy(block, map + offset, BLOCK_SIZE);
+    return SUCCESS;
+  }
+  return preadFull(fd, block, BLOCK_SIZE, offset);
+}
+
+int Disk::writeToDataFile(unsigned char *block, int blockNum) {
+  const off_t offset = (off_t)blockNum * BLOCK_SIZE;
+  if (mode == DISK_MODE_MMAP) {
+    memcpy(map + offset, block, BLOCK_SIZE);
+    return SUCCESS;
+  }
+  return pwriteFull(fd, block, BLOCK_SIZE, offset);
 }
 
 /*
@@ -41,16 +242,29 @@ Disk::~Disk() {
  * block - Memory pointer of the buffer to which the block contents is to be loaded/read.
  *         (MUST be Allocated by caller)
  * blockNum - Block number of the disk block to be read.
+ * If the block has an after-image in the log that is newer than the disk file,
+ * it is read from the log.
  */
 int Disk::readBlock(unsigned char *block, int blockNum) {
-  FILE *disk = fopen(DISK_RUN_COPY_PATH, "rb");
   if (blockNum < 0 || blockNum > DISK_BLOCKS - 1) {
     return E_OUTOFBOUND;
   }
-  const int offset = blockNum * BLOCK_SIZE;
-  fseek(disk, offset, SEEK_SET);
-  fread(block, BLOCK_SIZE, 1, disk);
-  fclose(disk);
+
+  int ret;
+  {
+    std::lock_guard<std::mutex> guard(walLock);
+    if (walOffset[blockNum] >= 0) {
+      ret = preadFull(walFd, block, BLOCK_SIZE, walOffset[blockNum]);
+    } else {
+      ret = readFromDataFile(block, blockNum);
+    }
+  }
+  if (ret != SUCCESS) {
+    return ret;
+  }
+
+  numReads++;
+  numBytesRead += BLOCK_SIZE;
   return SUCCESS;
 }
 
@@ -59,15 +273,215 @@ int Disk::readBlock(unsigned char *block, int blockNum) {
  * block - Memory pointer of the buffer to which contain the contents to be written.
  *         (MUST be Allocated by caller)
  * blockNum - Block number of the disk block to be written into.
+ * The after-image is written to the log; it becomes durable at the next flush()
+ * and reaches the disk file at the next checkpoint. A block written again before
+ * the next commit overwrites its own (uncommitted) log record.
  */
 int Disk::writeBlock(unsigned char *block, int blockNum) {
-  FILE *disk = fopen(DISK_RUN_COPY_PATH, "rb+");
   if (blockNum < 0 || blockNum > DISK_BLOCKS - 1) {
     return E_OUTOFBOUND;
   }
-  const int offset = blockNum * BLOCK_SIZE;
-  fseek(disk, offset, SEEK_SET);
-  fwrite(block, BLOCK_SIZE, 1, disk);
-  fclose(disk);
+  if (walFd < 0) {
+    return FAILURE;
+  }
+
+  WalRecordHeader header;
+  header.magic = WAL_MAGIC;
+  header.type = WAL_BLOCK;
+  header.blockNum = blockNum;
+  header.checksum = walChecksum(header, block);
+
+  {
+    std::lock_guard<std::mutex> guard(walLock);
+    int64_t recordOffset;
+    if (walOffset[blockNum] >= walCommitEnd) {
+      recordOffset = walOffset[blockNum] - (int64_t)sizeof(header);
+    } else {
+      recordOffset = walEnd;
+      walEnd += sizeof(header) + BLOCK_SIZE;
+    }
+
+    // write header and block with a single call so that the record is written in one piece
+    unsigned char record[sizeof(header) + BLOCK_SIZE];
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), block, BLOCK_SIZE);
+    if (pwriteFull(walFd, record, sizeof(record), recordOffset) != SUCCESS) {
+      return FAILURE;
+    }
+    walOffset[blockNum] = recordOffset + sizeof(header);
+  }
+
+  numWrites++;
+  numBytesWritten += BLOCK_SIZE;
+  return SUCCESS;
+}
+
+/*
+ * Writes `count` blocks at once: blocks holds the contents of the blocks one
+ * after the other (count * BLOCK_SIZE bytes) and blockNums their block numbers.
+ * The after-images are appended to the log with a single vectored write
+ * (blocks that already have an uncommitted record overwrite it, as in writeBlock()).
+ */
+int Disk::writeBlocks(unsigned char *blocks, int *blockNums, int count) {
+  if (walFd < 0) {
+    return FAILURE;
+  }
+  for (int i = 0; i < count; i++) {
+    if (blockNums[i] < 0 || blockNums[i] > DISK_BLOCKS - 1) {
+      return E_OUTOFBOUND;
+    }
+  }
+
+  WalRecordHeader headers[count];
+  struct iovec iov[2 * count];
+  for (int i = 0; i < count; i++) {
+    headers[i].magic = WAL_MAGIC;
+    headers[i].type = WAL_BLOCK;
+    headers[i].blockNum = blockNums[i];
+    headers[i].checksum = walChecksum(headers[i], blocks + (size_t)i * BLOCK_SIZE);
+    iov[2 * i].iov_base = &headers[i];
+    iov[2 * i].iov_len = sizeof(WalRecordHeader);
+    iov[2 * i + 1].iov_base = blocks + (size_t)i * BLOCK_SIZE;
+    iov[2 * i + 1].iov_len = BLOCK_SIZE;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(walLock);
+    // overwrite the uncommitted records in place and gather the rest at the front of iov
+    int numAppended = 0;
+    int appendedBlocks[count];
+    for (int i = 0; i < count; i++) {
+      int blockNum = blockNums[i];
+      if (walOffset[blockNum] >= walCommitEnd) {
+        if (pwritevFull(walFd, &iov[2 * i], 2, walOffset[blockNum] - (int64_t)sizeof(WalRecordHeader)) != SUCCESS) {
+          return FAILURE;
+        }
+        continue;
+      }
+      iov[2 * numAppended] = iov[2 * i];
+      iov[2 * numAppended + 1] = iov[2 * i + 1];
+      appendedBlocks[numAppended] = blockNum;
+      numAppended++;
+    }
+
+    int64_t recordOffset = walEnd;
+    // (IOV_MAX is at least 1024, callers write far fewer blocks at a time)
+    if (numAppended > 0 && pwritevFull(walFd, iov, 2 * numAppended, recordOffset) != SUCCESS) {
+      return FAILURE;
+    }
+    for (int i = 0; i < numAppended; i++) {
+      walOffset[appendedBlocks[i]] = recordOffset + (int64_t)sizeof(WalRecordHeader);
+      recordOffset += sizeof(WalRecordHeader) + BLOCK_SIZE;
+    }
+    walEnd = recordOffset;
+  }
+
+  numWrites += count;
+  numBytesWritten += (int64_t)count * BLOCK_SIZE;
   return SUCCESS;
-}
\ No newline at end of file
+}
+
+/*
+ * Commits the log: appends a commit record and forces the log to disk. Every
+ * block written before this call survives a crash from here on.
+ * Once the log has grown past WAL_CHECKPOINT_SIZE it is checkpointed.
+ */
+int Disk::flush() {
+  if (walFd < 0) {
+    return FAILURE;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(walLock);
+    if (walEnd == walCommitEnd) {
+      return SUCCESS;  // nothing written since the last commit
+    }
+
+    WalRecordHeader header;
+    header.magic = WAL_MAGIC;
+    header.type = WAL_COMMIT;
+    header.blockNum = -1;
+    header.checksum = walChecksum(header, nullptr);
+    if (pwriteFull(walFd, &header, sizeof(header), walEnd) != SUCCESS) {
+      return FAILURE;
+    }
+    walEnd += sizeof(header);
+    if (fdatasync(walFd) != 0) {
+      return FAILURE;
+    }
+    walCommitEnd = walEnd;
+  }
+  numCommits++;
+
+  if (walEnd >= WAL_CHECKPOINT_SIZE) {
+    return checkpoint();
+  }
+  return SUCCESS;
+}
+
+/*
+ * Copies the latest committed after-image of every logged block into the disk
+ * file, forces the disk file to disk and empties the log.
+ * Must only be called when everything in the log is committed.
+ */
+int Disk::checkpoint() {
+  std::lock_guard<std::mutex> guard(walLock);
+  if (walEnd == 0 || walEnd != walCommitEnd) {
+    return SUCCESS;
+  }
+
+  unsigned char block[BLOCK_SIZE];
+  for (int blockNum = 0; blockNum < DISK_BLOCKS; blockNum++) {
+    if (walOffset[blockNum] < 0) {
+      continue;
+    }
+    if (preadFull(walFd, block, BLOCK_SIZE, walOffset[blockNum]) != SUCCESS ||
+        writeToDataFile(block, blockNum) != SUCCESS) {
+      return FAILURE;
+    }
+  }
+
+  int ret = (mode == DISK_MODE_MMAP) ? msync(map, DISK_SIZE, MS_SYNC) : fdatasync(fd);
+  if (ret != 0) {
+    return FAILURE;
+  }
+
+  // the disk file now holds everything in the log
+  if (ftruncate(walFd, 0) != 0) {
+    return FAILURE;
+  }
+  for (int blockNum = 0; blockNum < DISK_BLOCKS; blockNum++) {
+    walOffset[blockNum] = -1;
+  }
+  walEnd = 0;
+  walCommitEnd = 0;
+  numCheckpoints++;
+  return SUCCESS;
+}
+
+int Disk::getMode() {
+  return mode;
+}
+
+/*
+ * Copies the number of block reads/writes (and bytes transferred), log commits
+ * and checkpoints performed since the start of the session or the last
+ * resetIOStats() into *stats.
+ */
+void Disk::getIOStats(DiskIOStats *stats) {
+  stats->reads = numReads.load();
+  stats->writes = numWrites.load();
+  stats->bytesRead = numBytesRead.load();
+  stats->bytesWritten = numBytesWritten.load();
+  stats->commits = numCommits.load();
+  stats->checkpoints = numCheckpoints.load();
+}
+
+void Disk::resetIOStats() {
+  numReads = 0;
+  numWrites = 0;
+  numBytesRead = 0;
+  numBytesWritten = 0;
+  numCommits = 0;
+  numCheckpoints = 0;
+}
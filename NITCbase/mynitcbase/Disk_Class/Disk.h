@@ -1,10 +1,78 @@
 #ifndef NITCBASE_H
 #define NITCBASE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "../define/constants.h"
+
+/* how the disk file is accessed (selected at startup) */
+enum DiskMode {
+  DISK_MODE_PREAD = 0,  // pread()/pwrite() on a descriptor kept open for the session
+  DISK_MODE_MMAP = 1    // the whole disk file is mmap()ed; blocks are memcpy'd in and out
+};
+
+/* per-call I/O counters of the disk layer (see Disk::getIOStats()) */
+struct DiskIOStats {
+  int64_t reads;
+  int64_t writes;
+  int64_t bytesRead;
+  int64_t bytesWritten;
+  int64_t commits;
+  int64_t checkpoints;
+};
+
+/* header of a record in the write-ahead log (followed by BLOCK_SIZE bytes for WAL_BLOCK) */
+struct WalRecordHeader {
+  uint32_t magic;
+  int32_t type;
+  int32_t blockNum;
+  uint32_t checksum;
+};
+
+enum WalRecordType {
+  WAL_BLOCK = 1,  // after-image of a block
+  WAL_COMMIT = 2  // every record before this one is durable
+};
+
 class Disk {
+ private:
+  // descriptor of the disk file, kept open for the whole session
+  static int fd;
+  static int mode;
+  // start of the mapping of the disk file (DISK_MODE_MMAP only)
+  static unsigned char *map;
+
+  // write-ahead log: descriptor, end offset, offset of the end of the last
+  // commit record and the offset of the latest after-image of every block
+  static int walFd;
+  static int64_t walEnd;
+  static int64_t walCommitEnd;
+  static int64_t walOffset[DISK_BLOCKS];
+  static std::mutex walLock;
+
+  static std::atomic<int64_t> numReads;
+  static std::atomic<int64_t> numWrites;
+  static std::atomic<int64_t> numBytesRead;
+  static std::atomic<int64_t> numBytesWritten;
+  static std::atomic<int64_t> numCommits;
+  static std::atomic<int64_t> numCheckpoints;
+
+  static int readFromDataFile(unsigned char *block, int blockNum);
+  static int writeToDataFile(unsigned char *block, int blockNum);
+  static int recover();
+  static int checkpoint();
+
  public:
-  Disk();
+  Disk(int diskMode = DISK_MODE_PREAD);
   ~Disk();
   static int readBlock(unsigned char *block, int blockNum);
   static int writeBlock(unsigned char *block, int blockNum);
+  static int writeBlocks(unsigned char *blocks, int *blockNums, int count);
+  static int flush();
+  static int getMode();
+  static void getIOStats(DiskIOStats *stats);
+  static void resetIOStats();
 };
-#endif  // NITCBASE_H
\ No newline at end of file
+#endif  // NITCBASE_H
@@ -1,8 +1,14 @@
 #include "Frontend.h"
 
+#include <strings.h>
+
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 
+#include "../Buffer/StaticBuffer.h"
+#include "../Disk_Class/Disk.h"
+
 int Frontend::create_table(char relname[ATTR_SIZE], int no_attrs, char attributes[][ATTR_SIZE],
                            int type_attrs[]) {
   // Schema::createRel
@@ -46,6 +52,25 @@ int Frontend::insert_into_table_values(char relname[ATTR_SIZE], int attr_count,
   return Algebra::insert(relname, attr_count, attr_values);
 }
 
+int Frontend::insert_into_table_values_bulk(char relname[ATTR_SIZE], int attr_count, int row_count,
+                                            char attr_values[][ATTR_SIZE], int *rows_inserted) {
+  // Algebra::bulkInsert
+  return Algebra::bulkInsert(relname, attr_count, row_count, attr_values, rows_inserted);
+}
+
+int Frontend::delete_from_table_where(char relname[ATTR_SIZE], char attribute[ATTR_SIZE], int op,
+                                      char value[ATTR_SIZE], int *rows_deleted) {
+  // Algebra::deleteWhere
+  return Algebra::deleteWhere(relname, attribute, op, value, rows_deleted);
+}
+
+int Frontend::update_table_set_where(char relname[ATTR_SIZE], char set_attribute[ATTR_SIZE],
+                                     char set_value[ATTR_SIZE], char attribute[ATTR_SIZE], int op,
+                                     char value[ATTR_SIZE], int *rows_updated) {
+  // Algebra::updateWhere
+  return Algebra::updateWhere(relname, set_attribute, set_value, attribute, op, value, rows_updated);
+}
+
 int Frontend::select_from_table(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE]) {
   // Algebra::project
   return Algebra::project(relname_source, relname_target);
@@ -67,40 +92,34 @@ int Frontend::select_attrlist_from_table_where(char relname_source[ATTR_SIZE], c
                                                int attr_count, char attr_list[][ATTR_SIZE],
                                                char attribute[ATTR_SIZE], int op, char value[ATTR_SIZE]) {
 
-      // Call select() method of the Algebra Layer with correct arguments to
-    // create a temporary target relation with name ".temp" (use constant TEMP)
-  char temp[ATTR_SIZE] = TEMP;
-    int ret = Algebra::select(relname_source, temp, attribute, op, value);
-
-    // TEMP will contain all the attributes of the source relation as it is the
-    // result of a select operation
-    if(ret != SUCCESS)
-      return ret;
-
-    // Return Error values, if not successful
-
-    // Open the TEMP relation using OpenRelTable::openRel()
-    int relid = OpenRelTable::openRel(temp);
-    // if open fails, delete TEMP relation using Schema::deleteRel() and
-    if(relid<0 || relid>=MAX_OPEN)
-    {
-      Schema::deleteRel(temp);
-      return relid;
-    }
-    // return the error code
+  // Algebra::select + project in one pipeline (no TEMP relation)
+  return Algebra::select(relname_source, relname_target, attribute, op, value, attr_count, attr_list);
+}
 
-    // On the TEMP relation, call project() method of the Algebra Layer with
-    // correct arguments to create the actual target relation. The final
-    // target relation contains only those attributes mentioned in attr_list
+// attr_count is 0 for SELECT * (every attribute of the source is kept)
+int Frontend::select_from_table_order_by(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
+                                         int attr_count, char attr_list[][ATTR_SIZE],
+                                         char order_attribute[ATTR_SIZE], bool descending) {
+  // Algebra::sort
+  if (attr_count == 0)
+    return Algebra::sort(relname_source, relname_target, order_attribute, descending);
+  return Algebra::sort(relname_source, relname_target, order_attribute, descending, attr_count, attr_list);
+}
 
-    ret = Algebra::project(temp, relname_target, attr_count, attr_list);
+int Frontend::select_from_table_where_order_by(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
+                                               int attr_count, char attr_list[][ATTR_SIZE],
+                                               char attribute[ATTR_SIZE], int op, char value[ATTR_SIZE],
+                                               char order_attribute[ATTR_SIZE], bool descending) {
+  // Algebra::sort of the selected records (no TEMP relation)
+  return Algebra::sort(relname_source, relname_target, order_attribute, descending, attr_count, attr_list, attribute,
+                       op, value);
+}
 
-    // close the TEMP relation using OpenRelTable::closeRel()
-    Schema::closeRel(temp);
-    // delete the TEMP relation using Schema::deleteRel()
-    Schema::deleteRel(temp);
-    return ret;
-    // return any error codes from project() or SUCCESS otherwise
+int Frontend::select_aggregate_from_table_group_by(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
+                                                   int item_count, int functions[], char item_attrs[][ATTR_SIZE],
+                                                   char group_attribute[ATTR_SIZE]) {
+  // Algebra::groupBy
+  return Algebra::groupBy(relname_source, relname_target, group_attribute, item_count, functions, item_attrs);
 }
 
 int Frontend::select_from_join_where(char relname_source_one[ATTR_SIZE], char relname_source_two[ATTR_SIZE],
@@ -114,27 +133,9 @@ int Frontend::select_attrlist_from_join_where(char relname_source_one[ATTR_SIZE]
                                               char relname_target[ATTR_SIZE],
                                               char join_attr_one[ATTR_SIZE], char join_attr_two[ATTR_SIZE],
                                               int attr_count, char attr_list[][ATTR_SIZE]) {
-  // Algebra::join + project
-  char temp[ATTR_SIZE]=TEMP;
-  int ret=Algebra::join(relname_source_one,relname_source_two,temp,join_attr_one,join_attr_two);
-  if(ret!=SUCCESS)
-  {
-    return ret;
-  }
-  ret=OpenRelTable::openRel(temp);
-  if(ret==E_CACHEFULL)
-  {
-    Schema::deleteRel(temp);
-    return ret;
-  }
-  ret=Algebra::project(temp,relname_target,attr_count,attr_list);
-  Schema::closeRel(temp);
-  Schema::deleteRel(temp);
-  if(ret!=SUCCESS)
-  {
-    return ret;
-  }
-  return SUCCESS;
+  // Algebra::join + project in one pipeline (no TEMP relation)
+  return Algebra::join(relname_source_one, relname_source_two, relname_target, join_attr_one, join_attr_two,
+                       attr_count, attr_list);
 }
 
 int Frontend::custom_function(int argc, char argv[][ATTR_SIZE]) {
@@ -143,5 +144,34 @@ int Frontend::custom_function(int argc, char argv[][ATTR_SIZE]) {
 
   // implement whatever you desire
 
+  // FUNCTION IOSTATS [RESET] - print the disk I/O counters of this session
+  if (argc >= 1 && strcasecmp(argv[0], "IOSTATS") == 0) {
+    DiskIOStats stats;
+    Disk::getIOStats(&stats);
+    printf("Disk reads: %lld (%lld bytes)\n", (long long)stats.reads, (long long)stats.bytesRead);
+    printf("Disk writes: %lld (%lld bytes)\n", (long long)stats.writes, (long long)stats.bytesWritten);
+    if (argc >= 2 && strcasecmp(argv[1], "RESET") == 0) {
+      Disk::resetIOStats();
+    }
+    return SUCCESS;
+  }
+
+  // FUNCTION BUFSTATS [RESET] - print the hit rate of the buffer pool in this session
+  if (argc >= 1 && strcasecmp(argv[0], "BUFSTATS") == 0) {
+    BufferStats stats;
+    StaticBuffer::getBufferStats(&stats);
+    int64_t accesses = stats.hits + stats.misses;
+    printf("Buffer frames: %d\n", StaticBuffer::getBufferCapacity());
+    printf("Buffer hits: %lld, misses: %lld (hit rate %.2f%%)\n", (long long)stats.hits,
+           (long long)stats.misses, accesses == 0 ? 0.0 : 100.0 * stats.hits / accesses);
+    printf("Evictions: %lld (%lld dirty)\n", (long long)stats.evictions, (long long)stats.dirtyEvictions);
+    printf("Background writes: %lld\n", (long long)stats.backgroundWrites);
+    printf("Blocks read ahead: %lld (%lld used)\n", (long long)stats.prefetches, (long long)stats.prefetchHits);
+    if (argc >= 2 && strcasecmp(argv[1], "RESET") == 0) {
+      StaticBuffer::resetBufferStats();
+    }
+    return SUCCESS;
+  }
+
   return SUCCESS;
 }
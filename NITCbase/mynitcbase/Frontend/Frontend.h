@@ -27,6 +27,16 @@ class Frontend {
   // DML
   static int insert_into_table_values(char relname[ATTR_SIZE], int attr_count, char attr_values[][ATTR_SIZE]);
 
+  static int insert_into_table_values_bulk(char relname[ATTR_SIZE], int attr_count, int row_count,
+                                           char attr_values[][ATTR_SIZE], int *rows_inserted);
+
+  static int delete_from_table_where(char relname[ATTR_SIZE], char attribute[ATTR_SIZE], int op,
+                                     char value[ATTR_SIZE], int *rows_deleted);
+
+  static int update_table_set_where(char relname[ATTR_SIZE], char set_attribute[ATTR_SIZE],
+                                    char set_value[ATTR_SIZE], char attribute[ATTR_SIZE], int op,
+                                    char value[ATTR_SIZE], int *rows_updated);
+
   static int select_from_table(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE]);
 
   static int select_attrlist_from_table(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
@@ -39,6 +49,19 @@ class Frontend {
                                               int attr_count, char attr_list[][ATTR_SIZE],
                                               char attribute[ATTR_SIZE], int op, char value[ATTR_SIZE]);
 
+  static int select_from_table_order_by(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
+                                        int attr_count, char attr_list[][ATTR_SIZE],
+                                        char order_attribute[ATTR_SIZE], bool descending);
+
+  static int select_from_table_where_order_by(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
+                                              int attr_count, char attr_list[][ATTR_SIZE],
+                                              char attribute[ATTR_SIZE], int op, char value[ATTR_SIZE],
+                                              char order_attribute[ATTR_SIZE], bool descending);
+
+  static int select_aggregate_from_table_group_by(char relname_source[ATTR_SIZE], char relname_target[ATTR_SIZE],
+                                                  int item_count, int functions[], char item_attrs[][ATTR_SIZE],
+                                                  char group_attribute[ATTR_SIZE]);
+
   static int select_from_join_where(char relname_source_one[ATTR_SIZE], char relname_source_two[ATTR_SIZE],
                                     char relname_target[ATTR_SIZE],
                                     char join_attr_one[ATTR_SIZE], char join_attr_two[ATTR_SIZE]);
@@ -1,4 +1,5 @@
 // clang-format off
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <string>
@@ -225,59 +226,108 @@ int RegexHandler::insertFromFileHandler() {
   string filePath = string(INPUT_FILES_PATH) + m[2].str();
   std::cout << "File path: " << filePath << endl;
 
-  ifstream file(filePath);
+  ifstream file(filePath, ios::binary);
   if (!file.is_open()) {
     cout << "Invalid file path or file does not exist" << endl;
     return FAILURE;
   }
 
+  /*
+   * The file is read BULK_LOAD_CHUNK_SIZE bytes at a time and split into
+   * truncated fields in place; all the rows are then handed to the bulk
+   * loader in one call so that indexes are only maintained once.
+   */
   string errorMsg("");
-  string fileLine;
-
-  int retVal = SUCCESS;
+  vector<char> chunk(BULK_LOAD_CHUNK_SIZE);
+  string pending;                 // an incomplete line carried over to the next chunk
+  vector<char> rows;              // parsed rows, ATTR_SIZE bytes per field
   int columnCount = -1, lineNumber = 1;
-  while (getline(file, fileLine)) {
-    vector<string> row;
-
-    stringstream lineStream(fileLine);
+  int retVal = SUCCESS;
 
-    string item;
-    while (getline(lineStream, item, ',')) {
-      if (item.size() == 0) {
+  // splits one line into fields and appends them to rows
+  auto parseLine = [&](const char *line, size_t length) {
+    int fields = 0;
+    size_t start = 0;
+    while (start < length) {
+      size_t end = start;
+      while (end < length && line[end] != ',') {
+        end++;
+      }
+      if (end == start) {
         errorMsg += "Null values not allowed in attribute values\n";
-        retVal = FAILURE;
-        break;
+        return FAILURE;
       }
-      row.push_back(item);
-    }
-    if (retVal == FAILURE) {
-      break;
+      size_t keep = min(end - start, (size_t)ATTR_SIZE - 1);
+      char field[ATTR_SIZE] = {0};
+      memcpy(field, line + start, keep);
+      if (end - start >= ATTR_SIZE) {
+        printf("(warning: \'%s\' truncated to \'%s\')\n", string(line + start, end - start).c_str(), field);
+      }
+      rows.insert(rows.end(), field, field + ATTR_SIZE);
+      fields++;
+      start = end + 1;
     }
 
     if (columnCount == -1) {
-      columnCount = row.size();
-    } else if (columnCount != row.size()) {
+      columnCount = fields;
+    } else if (columnCount != fields) {
+      rows.resize(rows.size() - (size_t)fields * ATTR_SIZE);
       errorMsg += "Mismatch in number of attributes\n";
-      retVal = FAILURE;
-      break;
-    }
-
-    char rowArray[columnCount][ATTR_SIZE];
-    for (int i = 0; i < columnCount; ++i) {
-      attrToTruncatedArray(row[i], rowArray[i]);
+      return FAILURE;
     }
+    return SUCCESS;
+  };
 
-    retVal = Frontend::insert_into_table_values(relName, columnCount, rowArray);
-
-    if (retVal != SUCCESS) {
+  while (retVal == SUCCESS && file) {
+    file.read(chunk.data(), chunk.size());
+    size_t length = file.gcount();
+    if (length == 0) {
       break;
     }
 
-    lineNumber++;
+    size_t lineStart = 0;
+    for (size_t i = 0; i < length && retVal == SUCCESS; i++) {
+      if (chunk[i] != '\n') {
+        continue;
+      }
+      if (pending.empty()) {
+        retVal = parseLine(chunk.data() + lineStart, i - lineStart);
+      } else {
+        pending.append(chunk.data() + lineStart, i - lineStart);
+        retVal = parseLine(pending.data(), pending.size());
+        pending.clear();
+      }
+      if (retVal == SUCCESS) {
+        lineNumber++;
+      }
+      lineStart = i + 1;
+    }
+    if (retVal == SUCCESS) {
+      pending.append(chunk.data() + lineStart, length - lineStart);
+    }
+  }
+  // last line without a trailing newline
+  if (retVal == SUCCESS && !pending.empty()) {
+    retVal = parseLine(pending.data(), pending.size());
+    if (retVal == SUCCESS) {
+      lineNumber++;
+    }
   }
 
   file.close();
 
+  int rowCount = lineNumber - 1;
+  int parseError = retVal;
+  int rowsInserted = 0;
+  if (rowCount > 0) {
+    retVal = Frontend::insert_into_table_values_bulk(relName, columnCount, rowCount,
+                                                     (char(*)[ATTR_SIZE])rows.data(), &rowsInserted);
+    if (retVal == SUCCESS) {
+      retVal = parseError;
+    }
+  }
+  lineNumber = rowsInserted + 1;
+
   if (retVal == SUCCESS) {
     cout << lineNumber - 1 << " rows inserted successfully" << endl;
   } else {
@@ -294,6 +344,47 @@ int RegexHandler::insertFromFileHandler() {
   return retVal;
 }
 
+int RegexHandler::deleteFromWhereHandler() {
+  char relName[ATTR_SIZE];
+  char attribute[ATTR_SIZE];
+  char valueStr[ATTR_SIZE];
+  attrToTruncatedArray(m[1], relName);
+  attrToTruncatedArray(m[2], attribute);
+  int op = getOperator(m[3]);
+  attrToTruncatedArray(m[4], valueStr);
+
+  int rowsDeleted = 0;
+  int ret = Frontend::delete_from_table_where(relName, attribute, op, valueStr, &rowsDeleted);
+  if (ret == SUCCESS) {
+    cout << rowsDeleted << " rows deleted successfully" << endl;
+  }
+
+  return ret;
+}
+
+int RegexHandler::updateSetWhereHandler() {
+  char relName[ATTR_SIZE];
+  char setAttribute[ATTR_SIZE];
+  char setValueStr[ATTR_SIZE];
+  char attribute[ATTR_SIZE];
+  char valueStr[ATTR_SIZE];
+  attrToTruncatedArray(m[1], relName);
+  attrToTruncatedArray(m[2], setAttribute);
+  attrToTruncatedArray(m[3], setValueStr);
+  attrToTruncatedArray(m[4], attribute);
+  int op = getOperator(m[5]);
+  attrToTruncatedArray(m[6], valueStr);
+
+  int rowsUpdated = 0;
+  int ret = Frontend::update_table_set_where(relName, setAttribute, setValueStr, attribute, op, valueStr,
+                                             &rowsUpdated);
+  if (ret == SUCCESS) {
+    cout << rowsUpdated << " rows updated successfully" << endl;
+  }
+
+  return ret;
+}
+
 int RegexHandler::selectFromHandler() {
   char sourceRelName[ATTR_SIZE];
   char targetRelName[ATTR_SIZE];
@@ -378,6 +469,123 @@ int RegexHandler::selectAttrFromWhereHandler() {
   return ret;
 }
 
+int RegexHandler::selectFromOrderHandler() {
+  char sourceRelName[ATTR_SIZE];
+  char targetRelName[ATTR_SIZE];
+  char orderAttribute[ATTR_SIZE];
+
+  attrToTruncatedArray(m[2], sourceRelName);
+  attrToTruncatedArray(m[3], targetRelName);
+  attrToTruncatedArray(m[4], orderAttribute);
+  bool descending = strcasecmp(m[5].str().c_str(), "DESC") == 0;
+
+  // SELECT * is passed on as an empty attribute list
+  vector<string> attrTokens;
+  if (m[1] != "*")
+    attrTokens = extractTokens(m[1]);
+
+  int attrCount = attrTokens.size();
+  char attrNames[attrCount + 1][ATTR_SIZE];
+  for (int i = 0; i < attrCount; i++) {
+    attrToTruncatedArray(attrTokens[i], attrNames[i]);
+  }
+
+  int ret = Frontend::select_from_table_order_by(sourceRelName, targetRelName, attrCount, attrNames,
+                                                 orderAttribute, descending);
+  if (ret == SUCCESS) {
+    cout << "Selected successfully into " << targetRelName << endl;
+  }
+
+  return ret;
+}
+
+int RegexHandler::selectFromWhereOrderHandler() {
+  char sourceRelName[ATTR_SIZE];
+  char targetRelName[ATTR_SIZE];
+  char attribute[ATTR_SIZE];
+  char value[ATTR_SIZE];
+  char orderAttribute[ATTR_SIZE];
+
+  attrToTruncatedArray(m[2], sourceRelName);
+  attrToTruncatedArray(m[3], targetRelName);
+  attrToTruncatedArray(m[4], attribute);
+  int op = getOperator(m[5]);
+  attrToTruncatedArray(m[6], value);
+  attrToTruncatedArray(m[7], orderAttribute);
+  bool descending = strcasecmp(m[8].str().c_str(), "DESC") == 0;
+
+  // SELECT * is passed on as an empty attribute list
+  vector<string> attrTokens;
+  if (m[1] != "*")
+    attrTokens = extractTokens(m[1]);
+
+  int attrCount = attrTokens.size();
+  char attrNames[attrCount + 1][ATTR_SIZE];
+  for (int i = 0; i < attrCount; i++) {
+    attrToTruncatedArray(attrTokens[i], attrNames[i]);
+  }
+
+  int ret = Frontend::select_from_table_where_order_by(sourceRelName, targetRelName, attrCount, attrNames,
+                                                       attribute, op, value, orderAttribute, descending);
+  if (ret == SUCCESS) {
+    cout << "Selected successfully into " << targetRelName << endl;
+  }
+
+  return ret;
+}
+
+int RegexHandler::selectGroupByHandler() {
+  char sourceRelName[ATTR_SIZE];
+  char targetRelName[ATTR_SIZE];
+  char groupAttribute[ATTR_SIZE];
+
+  attrToTruncatedArray(m[2], sourceRelName);
+  attrToTruncatedArray(m[3], targetRelName);
+  attrToTruncatedArray(m[4], groupAttribute);
+
+  // every item is either FUNCTION(attr), FUNCTION(*) or an attribute
+  string items = m[1];
+  regex itemRegex("\\s*(?:(COUNT|SUM|MIN|MAX|AVG)\\s*\\(\\s*(\\*|[#A-Za-z0-9_-]+)\\s*\\)|([#A-Za-z0-9_-]+))\\s*",
+                  regex_constants::icase);
+  vector<int> functions;
+  vector<string> itemAttrs;
+  for (sregex_iterator it(items.begin(), items.end(), itemRegex), end; it != end; ++it) {
+    smatch item = *it;
+    if (item[3].matched) {
+      functions.push_back(AGG_NONE);
+      itemAttrs.push_back(item[3]);
+      continue;
+    }
+    string function = item[1];
+    transform(function.begin(), function.end(), function.begin(), ::toupper);
+    if (function == "COUNT")
+      functions.push_back(AGG_COUNT);
+    else if (function == "SUM")
+      functions.push_back(AGG_SUM);
+    else if (function == "MIN")
+      functions.push_back(AGG_MIN);
+    else if (function == "MAX")
+      functions.push_back(AGG_MAX);
+    else
+      functions.push_back(AGG_AVG);
+    itemAttrs.push_back(item[2]);
+  }
+
+  int itemCount = functions.size();
+  char itemAttrNames[itemCount][ATTR_SIZE];
+  for (int i = 0; i < itemCount; i++) {
+    attrToTruncatedArray(itemAttrs[i], itemAttrNames[i]);
+  }
+
+  int ret = Frontend::select_aggregate_from_table_group_by(sourceRelName, targetRelName, itemCount, functions.data(),
+                                                           itemAttrNames, groupAttribute);
+  if (ret == SUCCESS) {
+    cout << "Selected successfully into " << targetRelName << endl;
+  }
+
+  return ret;
+}
+
 int RegexHandler::selectFromJoinHandler() {
   char sourceRelOneName[ATTR_SIZE];
   char sourceRelTwoName[ATTR_SIZE];
@@ -471,6 +679,9 @@ int RegexHandler::handle(const string command) {
     if (regex_match(command, testCommand)) {
       regex_search(command, m, testCommand);
       int status = (this->*handler)();
+      // commit the changes made by the command to the disk
+      OpenRelTable::writeBackCache();
+      StaticBuffer::flushAll();
       if (status == SUCCESS || status == EXIT) {
         return status;
       }
@@ -581,6 +792,8 @@ void printErrorMsg(int error) {
     cout << "Error: This operation is not permitted" << endl;
   else if (error == E_INDEX_BLOCKS_RELEASED)
     cout << "Warning: Operation succeeded, but some indexes had to be dropped" << endl;
+  else if (error == E_BUFFERFULL)
+    cout << "Error: Every buffer is pinned" << endl;
 }
 
 void printHelp() {
@@ -594,10 +807,14 @@ void printHelp() {
   printf("ALTER TABLE RENAME tablename COLUMN column_name TO new_column_name;\n\t-rename an attribute of an existing relation.\n\n");
   printf("INSERT INTO tablename VALUES ( value1,value2,value3,... );\n\t-insert a single record into the given relation. \n\n");
   printf("INSERT INTO tablename VALUES FROM filepath; \n\t-insert multiple records from a csv file \n\n");
+  printf("DELETE FROM tablename WHERE attrname OP value; \n\t-delete the records of the relation that satisfy the condition \n\n");
+  printf("UPDATE tablename SET attrname = value WHERE attrname OP value; \n\t-set an attribute of the records of the relation that satisfy the condition \n\n");
   printf("SELECT * FROM source_relation INTO target_relation; \n\t-creates a relation with the same attributes and records as of source relation\n\n");
   printf("SELECT Attribute1,Attribute2,....FROM source_relation INTO target_relation; \n\t-creates a relation with attributes specified and all records\n\n");
   printf("SELECT * FROM source_relation INTO target_relation WHERE attrname OP value; \n\t-retrieve records based on a condition and insert them into a target relation\n\n");
   printf("SELECT Attribute1,Attribute2,....FROM source_relation INTO target_relation;\n\t-creates a relation with the attributes specified and inserts those records which satisfy the given condition.\n\n");
+  printf("SELECT * FROM source_relation INTO target_relation [WHERE attrname OP value] ORDER BY attrname [ASC|DESC]; \n\t-like the commands above, with the records of the target relation sorted on an attribute of the source relation\n\n");
+  printf("SELECT attrname, COUNT(*), SUM(attr), MIN(attr), MAX(attr), AVG(attr), ... FROM source_relation INTO target_relation GROUP BY attrname; \n\t-creates a relation with one record per value of the attribute and the aggregates of its records\n\n");
   printf("SELECT * FROM source_relation1 JOIN source_relation2 INTO target_relation WHERE source_relation1.attribute1 = source_relation2.attribute2; \n\t-creates a new relation with by equi-join of both the source relations\n\n");
   printf("SELECT Attribute1,Attribute2,.. FROM source_relation1 JOIN source_relation2 INTO target_relation WHERE source_relation1.attribute1 = source_relation2.attribute2; \n\t-creates a new relation by equi-join of both the source relations with the attributes specified \n\n");
   printf("echo <any message> \n\t  -echo back the given string. \n\n");
@@ -26,9 +26,15 @@
 #define SELECT_ATTR_FROM_CMD "\\s*SELECT\\s+((?:[#A-Za-z0-9_-]+\\s*,\\s*)*(?:[#A-Za-z0-9_-]+))\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s*;?"
 #define SELECT_FROM_WHERE_CMD "\\s*SELECT\\s+\\*\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+WHERE\\s+([#A-Za-z0-9_-]+)\\s*(<|<=|>|>=|=|!=)\\s*([A-Za-z0-9_-]+|([0-9]+(\\.)[0-9]+))\\s*;?"
 #define SELECT_ATTR_FROM_WHERE_CMD "\\s*SELECT\\s+((?:[#A-Za-z0-9_-]+\\s*,\\s*)*(?:[#A-Za-z0-9_-]+))\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+WHERE\\s+([#A-Za-z0-9_-]+)\\s*(<|<=|>|>=|=|!=)\\s*([A-Za-z0-9_-]+|([0-9]+(\\.)[0-9]+))\\s*;?"
+#define SELECT_FROM_ORDER_CMD "\\s*SELECT\\s+(\\*|(?:[#A-Za-z0-9_-]+\\s*,\\s*)*(?:[#A-Za-z0-9_-]+))\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+ORDER\\s+BY\\s+([#A-Za-z0-9_-]+)(?:\\s+(ASC|DESC))?\\s*;?"
+#define SELECT_FROM_WHERE_ORDER_CMD "\\s*SELECT\\s+(\\*|(?:[#A-Za-z0-9_-]+\\s*,\\s*)*(?:[#A-Za-z0-9_-]+))\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+WHERE\\s+([#A-Za-z0-9_-]+)\\s*(<|<=|>|>=|=|!=)\\s*([0-9]+\\.[0-9]+|[A-Za-z0-9_-]+)\\s+ORDER\\s+BY\\s+([#A-Za-z0-9_-]+)(?:\\s+(ASC|DESC))?\\s*;?"
+#define AGGREGATE_ITEM "(?:(?:COUNT|SUM|MIN|MAX|AVG)\\s*\\(\\s*(?:\\*|[#A-Za-z0-9_-]+)\\s*\\)|[#A-Za-z0-9_-]+)"
+#define SELECT_GROUP_BY_CMD "\\s*SELECT\\s+((?:" AGGREGATE_ITEM "\\s*,\\s*)*" AGGREGATE_ITEM ")\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+GROUP\\s+BY\\s+([#A-Za-z0-9_-]+)\\s*;?"
 #define SELECT_FROM_JOIN_CMD "\\s*SELECT\\s+\\*\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+JOIN\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+WHERE\\s+([A-Za-z0-9_-]+)\\s*\\.([#A-Za-z0-9_-]+)\\s*\\=\\s*([A-Za-z0-9_-]+)\\s*\\.([#A-Za-z0-9_-]+)\\s*;?"
 #define SELECT_ATTR_FROM_JOIN_CMD "\\s*SELECT\\s+((?:[#A-Za-z0-9_-]+\\s*,\\s*)*(?:[#A-Za-z0-9_-]+))\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+JOIN\\s+([A-Za-z0-9_-]+)\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+WHERE\\s+([A-Za-z0-9_-]+)\\s*\\.([#A-Za-z0-9_-]+)\\s*\\=\\s*([A-Za-z0-9_-]+)\\s*\\.([#A-Za-z0-9_-]+)\\s*;?"
 #define INSERT_SINGLE_CMD "\\s*INSERT\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+VALUES\\s*\\(\\s*((?:(?:[A-Za-z0-9_-]+|[0-9]+\\.[0-9]+)\\s*,\\s*)*(?:[A-Za-z0-9_-]+|[0-9]+\\.[0-9]+))\\s*\\)\\s*;?"
+#define DELETE_FROM_WHERE_CMD "\\s*DELETE\\s+FROM\\s+([A-Za-z0-9_-]+)\\s+WHERE\\s+([#A-Za-z0-9_-]+)\\s*(<|<=|>|>=|=|!=)\\s*([0-9]+\\.[0-9]+|[A-Za-z0-9_-]+)\\s*;?"
+#define UPDATE_SET_WHERE_CMD "\\s*UPDATE\\s+([A-Za-z0-9_-]+)\\s+SET\\s+([#A-Za-z0-9_-]+)\\s*\\=\\s*([0-9]+\\.[0-9]+|[A-Za-z0-9_-]+)\\s+WHERE\\s+([#A-Za-z0-9_-]+)\\s*(<|<=|>|>=|=|!=)\\s*([0-9]+\\.[0-9]+|[A-Za-z0-9_-]+)\\s*;?"
 #define INSERT_MULTIPLE_CMD "\\s*INSERT\\s+INTO\\s+([A-Za-z0-9_-]+)\\s+VALUES\\s+FROM\\s+([a-zA-Z0-9_-]+\\.csv)\\s*;?"
 #define CUSTOM_CMD "\\s*FUNCTION\\s+([A-Za-z,#0-9\\s()_-]+)\\s*;?"
 
@@ -54,10 +60,15 @@ class RegexHandler {
       {REGEX(RENAME_COLUMN_CMD), &RegexHandler::renameColumnHandler},
       {REGEX(INSERT_SINGLE_CMD), &RegexHandler::insertSingleHandler},
       {REGEX(INSERT_MULTIPLE_CMD), &RegexHandler::insertFromFileHandler},
+      {REGEX(DELETE_FROM_WHERE_CMD), &RegexHandler::deleteFromWhereHandler},
+      {REGEX(UPDATE_SET_WHERE_CMD), &RegexHandler::updateSetWhereHandler},
       {REGEX(SELECT_FROM_CMD), &RegexHandler::selectFromHandler},
       {REGEX(SELECT_FROM_WHERE_CMD), &RegexHandler::selectFromWhereHandler},
       {REGEX(SELECT_ATTR_FROM_CMD), &RegexHandler::selectAttrFromHandler},
       {REGEX(SELECT_ATTR_FROM_WHERE_CMD), &RegexHandler::selectAttrFromWhereHandler},
+      {REGEX(SELECT_FROM_ORDER_CMD), &RegexHandler::selectFromOrderHandler},
+      {REGEX(SELECT_FROM_WHERE_ORDER_CMD), &RegexHandler::selectFromWhereOrderHandler},
+      {REGEX(SELECT_GROUP_BY_CMD), &RegexHandler::selectGroupByHandler},
       {REGEX(SELECT_FROM_JOIN_CMD), &RegexHandler::selectFromJoinHandler},
       {REGEX(SELECT_ATTR_FROM_JOIN_CMD), &RegexHandler::selectAttrFromJoinHandler},
       {REGEX(CUSTOM_CMD), &RegexHandler::customFunctionHandler},
@@ -82,10 +93,15 @@ class RegexHandler {
   int renameColumnHandler();
   int insertSingleHandler();
   int insertFromFileHandler();
+  int deleteFromWhereHandler();
+  int updateSetWhereHandler();
   int selectFromHandler();
   int selectFromWhereHandler();
   int selectAttrFromHandler();
   int selectAttrFromWhereHandler();
+  int selectFromOrderHandler();
+  int selectFromWhereOrderHandler();
+  int selectGroupByHandler();
   int selectFromJoinHandler();
   int selectAttrFromJoinHandler();
   int customFunctionHandler();
@@ -10,6 +10,14 @@ int Schema::openRel(char relName[ATTR_SIZE]) {
   // a valid rel-id will be within the range 0 <= relId < MAX_OPEN and any
   // error codes will be negative
   if(ret >= 0){
+    // rebuild any index of the relation still in the old key format
+    RelCatEntry relCatEntry;
+    RelCacheTable::getRelCatEntry(ret, &relCatEntry);
+    for (int i = 0; i < relCatEntry.numAttrs; i++) {
+      AttrCatEntry attrCatEntry;
+      AttrCacheTable::getAttrCatEntry(ret, i, &attrCatEntry);
+      BPlusTree::checkKeyFormat(ret, attrCatEntry.attrName);
+    }
     return SUCCESS;
   }
 
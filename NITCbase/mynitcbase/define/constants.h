@@ -2,7 +2,7 @@
 #define NITCBASE_CONSTANTS_H
 
 #define DISK_PATH "../Disk/disk"                            // Path to disk
-#define DISK_RUN_COPY_PATH "../Disk/disk_run_copy"          // Path to run copy of the disk
+#define DISK_WAL_PATH "../Disk/disk_wal"                    // Path to write-ahead log of the disk
 #define Files_Path "../Files/"                              // Path to Files directory
 #define INPUT_FILES_PATH "../Files/Input_Files/"            // Path to Input_Files directory inside the Files directory
 #define OUTPUT_FILES_PATH "../Files/Output_Files/"          // Path to Output_Files directory inside the Files directory
@@ -22,7 +22,19 @@
 #define LEAF_ENTRY_SIZE 32          // Size of an Leaf Index Entry in the Leaf Index Block (in bytes)
 
 #define DISK_BLOCKS 8192             // Number of block in disk
+#define WAL_CHECKPOINT_SIZE 4 * 1024 * 1024  // Size of write-ahead log (in bytes) after which it is checkpointed
 #define BUFFER_CAPACITY 32           // Total number of blocks available in the Buffer (Capacity of the Buffer in blocks)
+#define BACKGROUND_WRITER_INTERVAL_MS 100  // Interval at which the background writer writes back dirty buffers
+#define BACKGROUND_WRITE_BATCH 16          // Number of blocks written back by the background writer in one call
+#define BULK_LOAD_CHUNK_SIZE (1 << 20)     // Bytes of an input file read at a time by INSERT INTO ... VALUES FROM
+#define READ_AHEAD_BLOCKS 8                // Number of blocks of a record block / leaf chain read ahead of a sequential scan
+#define JOIN_MEMORY_BLOCKS 64              // Blocks of memory a hash join may fill with its build side before it partitions its inputs to disk
+#define MAX_JOIN_PARTITIONS 64             // Largest number of disk partitions a hash join splits its inputs into
+#define SORT_MEMORY_BLOCKS 64              // Blocks of memory an external sort fills with records before it writes them out as a sorted run
+#define MAX_MERGE_FANIN 16                 // Largest number of sorted runs merged at once (each one is read through a buffer)
+#define AGGREGATE_MEMORY_BLOCKS 64         // Blocks of memory a hash aggregate may fill with groups before it partitions the rest of its input to disk
+#define AGGREGATE_PARTITIONS 16            // Number of disk partitions a hash aggregate splits the records of groups that did not fit into
+#define MAX_AGGREGATE_DEPTH 3              // Times a partition of a hash aggregate may itself be partitioned again
 #define MAX_OPEN 12                  // Maximum number of relations allowed to be open and cached in Cache Layer.
 #define BLOCK_ALLOCATION_MAP_SIZE 4  // Number of blocks given for Block Allocation Map in the disk
 
@@ -60,6 +72,15 @@ enum ConditionalOperators {
   NE   // !=
 };
 
+enum AggregateFunctions {
+  AGG_NONE,   // the grouping attribute itself
+  AGG_COUNT,  // COUNT(*) or COUNT(attr)
+  AGG_SUM,    // SUM(attr)
+  AGG_MIN,    // MIN(attr)
+  AGG_MAX,    // MAX(attr)
+  AGG_AVG     // AVG(attr)
+};
+
 enum BlockType {
   REC,           // record block
   IND_INTERNAL,  // internal index block
@@ -119,6 +140,7 @@ enum ReturnTypes {
   E_NOTFOUND,               // Search for requested record unsuccessful
   E_BLOCKNOTINBUFFER,       // Block not found in buffer
   E_INDEX_BLOCKS_RELEASED,  // Due to insufficient disk space, index blocks have been released from the disk
+  E_BUFFERFULL,             // Every buffer is pinned
 };
 
 #define TEMP ".temp"  // Used for internal purposes
@@ -128,6 +150,15 @@ enum ReturnTypes {
 #define MIDDLE_INDEX_INTERNAL 50  // Index of the middle element in an Internal Node of a B+ tree
 #define MAX_KEYS_LEAF 63          // Maximum number of keys allowed in a Leaf Node of a B+ tree
 #define MIDDLE_INDEX_LEAF 31      // Index of the middle element in a Leaf Node of a B+ tree
+#define BPLUS_KEY_FORMAT 2        // Stored in numAttrs of a B+ tree root block: keys are normalized (see normalizeKey())
+                                  // and NUMBER internal nodes use INTERNAL_LAYOUT_NUMBER
+#define INTERNAL_LAYOUT_INTERLEAVED 0  // Stored in numSlots of an internal index block: entries are {lChild, key} pairs
+#define INTERNAL_LAYOUT_NUMBER 1       // Stored in numSlots of an internal index block: NUMBER keys and children in separate arrays
+#define LEAF_LAYOUT_PLAIN 0            // Stored in numSlots of a leaf index block: Index entries of LEAF_ENTRY_SIZE bytes
+#define LEAF_LAYOUT_PREFIX 1           // Stored in numSlots of a leaf index block: STRING keys with their common prefix stored once
+#define MAX_KEYS_LEAF_PREFIX 199       // Maximum number of keys allowed in a LEAF_LAYOUT_PREFIX leaf (half of one more always fits)
+#define PREFIX_COMPRESS_STRING_LEAVES 1 // 1 if new leaves of indexes on STRING attributes use LEAF_LAYOUT_PREFIX
+#define BPLUS_BULK_FILL_PERCENT 90  // How full CREATE INDEX packs B+ tree nodes (percent of the maximum keys)
 
 // Name strings for Relation Catalog and Attribute Catalog (as it is stored in the Relation catalog)
 #define RELCAT_RELNAME "RELATIONCAT"
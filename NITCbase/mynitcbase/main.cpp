@@ -1,15 +1,131 @@
+#include "Algebra/Algebra.h"
 #include "Buffer/StaticBuffer.h"
 #include "Cache/OpenRelTable.h"
 #include "Disk_Class/Disk.h"
 #include "FrontendInterface/FrontendInterface.h"
 #include<iostream>
+#include<cstdlib>
 #include<cstring>
 
+/* startup options of a session */
+struct StartupOptions {
+  int diskMode;
+  int bufferCapacity;
+  bool hugePages;
+  int bufferPolicy;
+  bool backgroundWrites;
+  int readAheadBlocks;
+  int sortMemoryBlocks;
+};
+
+/* maps a replacement policy name to its BufferPolicyType (-1 if unknown) */
+static int policyFromName(const char *name)
+{
+  if (strcmp(name, "clock") == 0)
+    return BUFFER_POLICY_CLOCK;
+  if (strcmp(name, "lru") == 0)
+    return BUFFER_POLICY_LRU;
+  if (strcmp(name, "2q") == 0)
+    return BUFFER_POLICY_2Q;
+  return -1;
+}
+
+/*
+ * Strips the startup options (arguments starting with "--") out of argv so that
+ * the frontend only sees the "run <file>" arguments. Options can also be given
+ * through environment variables.
+ *   --mmap       (or NITCBASE_DISK_MODE=mmap) : serve disk blocks from an mmap of the disk file
+ *   --buffers N  (or NITCBASE_BUFFERS=N)      : number of buffer frames (default BUFFER_CAPACITY)
+ *   --hugepages  (or NITCBASE_HUGEPAGES=1)    : back the buffer pool with huge pages
+ *   --policy P   (or NITCBASE_BUFFER_POLICY=P): buffer replacement policy, clock (default), lru or 2q
+ *   --no-bgwriter (or NITCBASE_BGWRITER=0)    : write dirty buffers back only when they are evicted
+ *   --readahead N (or NITCBASE_READAHEAD=N)   : blocks read ahead of sequential scans (0 to disable)
+ *   --sort-memory N (or NITCBASE_SORT_MEMORY=N): blocks of memory for each external sort (ORDER BY, merge join)
+ */
+static int parseOptions(int argc, char *argv[], StartupOptions *options)
+{
+  const char *envMode = getenv("NITCBASE_DISK_MODE");
+  if (envMode != nullptr && strcmp(envMode, "mmap") == 0)
+    options->diskMode = DISK_MODE_MMAP;
+  const char *envBuffers = getenv("NITCBASE_BUFFERS");
+  if (envBuffers != nullptr && atoi(envBuffers) > 0)
+    options->bufferCapacity = atoi(envBuffers);
+  const char *envHuge = getenv("NITCBASE_HUGEPAGES");
+  if (envHuge != nullptr && strcmp(envHuge, "1") == 0)
+    options->hugePages = true;
+  const char *envPolicy = getenv("NITCBASE_BUFFER_POLICY");
+  if (envPolicy != nullptr && policyFromName(envPolicy) != -1)
+    options->bufferPolicy = policyFromName(envPolicy);
+  const char *envWriter = getenv("NITCBASE_BGWRITER");
+  if (envWriter != nullptr && strcmp(envWriter, "0") == 0)
+    options->backgroundWrites = false;
+  const char *envReadAhead = getenv("NITCBASE_READAHEAD");
+  if (envReadAhead != nullptr && atoi(envReadAhead) >= 0)
+    options->readAheadBlocks = atoi(envReadAhead);
+  const char *envSortMemory = getenv("NITCBASE_SORT_MEMORY");
+  if (envSortMemory != nullptr && atoi(envSortMemory) > 0)
+    options->sortMemoryBlocks = atoi(envSortMemory);
+
+  int newArgc = 1;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--mmap") == 0)
+      options->diskMode = DISK_MODE_MMAP;
+    else if (strcmp(argv[i], "--no-bgwriter") == 0)
+      options->backgroundWrites = false;
+    else if (strcmp(argv[i], "--hugepages") == 0)
+      options->hugePages = true;
+    else if (strcmp(argv[i], "--buffers") == 0 && i + 1 < argc)
+    {
+      int capacity = atoi(argv[++i]);
+      if (capacity > 0)
+        options->bufferCapacity = capacity;
+      else
+        std::cerr << "Ignoring invalid buffer count " << argv[i] << std::endl;
+    }
+    else if (strcmp(argv[i], "--readahead") == 0 && i + 1 < argc)
+    {
+      int blocks = atoi(argv[++i]);
+      if (blocks >= 0)
+        options->readAheadBlocks = blocks;
+      else
+        std::cerr << "Ignoring invalid read-ahead " << argv[i] << std::endl;
+    }
+    else if (strcmp(argv[i], "--sort-memory") == 0 && i + 1 < argc)
+    {
+      int blocks = atoi(argv[++i]);
+      if (blocks > 0)
+        options->sortMemoryBlocks = blocks;
+      else
+        std::cerr << "Ignoring invalid sort memory " << argv[i] << std::endl;
+    }
+    else if (strcmp(argv[i], "--policy") == 0 && i + 1 < argc)
+    {
+      int policy = policyFromName(argv[++i]);
+      if (policy != -1)
+        options->bufferPolicy = policy;
+      else
+        std::cerr << "Ignoring unknown replacement policy " << argv[i] << std::endl;
+    }
+    else if (strncmp(argv[i], "--", 2) == 0)
+      std::cerr << "Ignoring unknown option " << argv[i] << std::endl;
+    else
+      argv[newArgc++] = argv[i];
+  }
+  return newArgc;
+}
+
 int main(int argc, char *argv[])
 {
+  StartupOptions options = {DISK_MODE_PREAD, BUFFER_CAPACITY, false, BUFFER_POLICY_CLOCK, true, READ_AHEAD_BLOCKS,
+                            SORT_MEMORY_BLOCKS};
+  argc = parseOptions(argc, argv, &options);
+  Algebra::setSortMemory(options.sortMemoryBlocks);
+
   /* Initialize the Run Copy of Disk */
-  Disk disk_run;
-  StaticBuffer buffer;
+  Disk disk_run(options.diskMode);
+  StaticBuffer buffer(options.bufferCapacity, options.hugePages, options.bufferPolicy,
+                      options.backgroundWrites, options.readAheadBlocks);
   OpenRelTable cache;
 
   // for(int i=0;i<2;i++)